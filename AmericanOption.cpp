@@ -0,0 +1,338 @@
+//A finite maturity american option class priced by a Crank-Nicolson finite difference engine
+
+#include "AmericanOption.hpp"
+#include "InputValidation.hpp"
+#include "Stats.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+void FDWorkspace::resize(std::size_t nodes)
+{
+	if (V.size() >= nodes)
+		return;
+
+	for (std::vector<double>* v : { &V, &S, &payoff, &rhs, &c_prime, &d_prime, &m_inv })
+		v->resize(nodes);
+}
+
+//Constructors
+
+AmericanOption::AmericanOption()							//default constructor has just initialized data members
+	:Option()
+{
+}
+
+AmericanOption::AmericanOption(const AmericanOption& o)		//copy constructor copies all data mebers
+	:S_val(o.S_val), K_val(o.K_val), T_val(o.T_val),
+	r_val(o.r_val), vol_val(o.vol_val), q_val(o.q_val), grid_val(o.grid_val)
+{
+	if (type() != o.type())
+		toggle();
+}
+
+//Destructor
+AmericanOption::~AmericanOption()
+{
+}
+
+//Selectors (get value of respective data member)
+double AmericanOption::S() const { return S_val; }
+double AmericanOption::K() const { return K_val; }
+double AmericanOption::T() const { return T_val; }
+double AmericanOption::r() const { return r_val; }
+double AmericanOption::vol() const { return vol_val; }
+double AmericanOption::q() const { return q_val; }
+const FDGrid& AmericanOption::grid() const { return grid_val; }
+
+//Modifiers (also check for negative input)
+void AmericanOption::S(double newS)
+{
+	if (newS < 0)
+	{
+		Stats::Add(Stats::ClampS);
+		S_val = InputValidation::default_S;
+	} else S_val = newS;
+}
+
+void AmericanOption::K(double newK)
+{
+	if (newK < 0)
+	{
+		Stats::Add(Stats::ClampK);
+		K_val = InputValidation::default_K;
+	} else K_val = newK;
+}
+
+void AmericanOption::T(double newT)
+{
+	if (newT < 0)
+	{
+		Stats::Add(Stats::ClampT);
+		T_val = InputValidation::default_T;
+	} else T_val = newT;
+}
+
+void AmericanOption::r(double newr)
+{
+	if (newr < 0)
+	{
+		Stats::Add(Stats::Clampr);
+		r_val = InputValidation::default_r;
+	} else r_val = newr;
+}
+
+void AmericanOption::vol(double newvol)
+{
+	if (newvol < 0)
+	{
+		Stats::Add(Stats::Clampvol);
+		vol_val = InputValidation::default_vol;
+	} else vol_val = newvol;
+}
+
+void AmericanOption::q(double newq)
+{
+	if (newq < 0)
+	{
+		Stats::Add(Stats::Clampq);
+		q_val = 0;
+	} else q_val = newq;
+}
+
+void AmericanOption::grid(const FDGrid& newgrid)
+{
+	grid_val = newgrid;
+}
+
+void AmericanOption::SetValues(const std::vector<double>& params)	//get values from a vector (need to be ordered according to data members)
+{
+	SetValues(params.data(), params.size());
+}
+
+void AmericanOption::SetValues(const double* params, std::size_t count)	//same from an array through the setters, count has to be at least 5
+{
+	assert(count >= 5);
+
+	S(params[0]);
+	K(params[1]);
+	T(params[2]);
+	r(params[3]);
+	vol(params[4]);
+	q((count > 5) ? params[5] : 0);
+}
+
+//Operator overloading
+AmericanOption&
+AmericanOption::operator=(const AmericanOption& src)		//assignment operator checks for self-assignment
+{
+	if (this == &src)
+		return *this;
+	else
+	{
+		S_val = src.S_val;
+		K_val = src.K_val;
+		T_val = src.T_val;
+		r_val = src.r_val;
+		vol_val = src.vol_val;
+		q_val = src.q_val;
+		grid_val = src.grid_val;
+		if (type() != src.type())
+			toggle();
+
+		return *this;
+	}
+}
+
+//Finite difference engine
+double AmericanOption::solve(bool call, FDWorkspace& ws) const
+{
+	double sgn = call ? 1.0 : -1.0;
+	bool american = grid_val.american;
+
+	if (T_val <= 0 || vol_val <= 0 || S_val <= 0)			//degenerate cases have closed forms
+	{
+		double fwd = sgn * (S_val * std::exp(-q_val * T_val) - K_val * std::exp(-r_val * T_val));
+		double value = std::max(fwd, 0.0);
+		if (american || T_val <= 0)
+			value = std::max(value, sgn * (S_val - K_val));
+		return std::max(value, 0.0);
+	}
+
+	double span = 2 * std::max(grid_val.width, 1.0) * vol_val * std::sqrt(T_val);	//grid width in log(S)
+	std::size_t N = std::max<std::size_t>(grid_val.space_steps, 4);
+	if (grid_val.max_dx > 0 && span / N > grid_val.max_dx)	//long or high vol contracts: more nodes, not coarser ones
+		N = (std::size_t)std::min(std::ceil(span / grid_val.max_dx), 65536.0);
+	N += N % 2;
+	std::size_t M = std::max<std::size_t>(grid_val.time_steps, 1);
+	ws.resize(N + 1);
+
+	double x0 = std::log(S_val);
+	double dx = span / N;
+
+	if (K_val > 0)												//stretch the grid so the strike falls on a node
+	{
+		double k = std::round((std::log(K_val) - x0) / dx);
+		if (k != 0 && std::fabs(k) < N / 2)
+			dx = (std::log(K_val) - x0) / k;
+	}
+
+	double* V = ws.V.data();
+	double* S = ws.S.data();
+	double* payoff = ws.payoff.data();
+	double* rhs = ws.rhs.data();
+	double* cp = ws.c_prime.data();
+	double* dp = ws.d_prime.data();
+	double* mi = ws.m_inv.data();
+
+	for (std::size_t i = 0; i <= N; i++)
+	{
+		S[i] = std::exp(x0 + ((double)i - (double)(N / 2)) * dx);
+		payoff[i] = std::max(sgn * (S[i] - K_val), 0.0);
+		V[i] = payoff[i];
+	}
+
+	double v2 = vol_val * vol_val;							//L V = l V[i-1] + d V[i] + u V[i+1]
+	double alpha = v2 / (2 * dx * dx);
+	double beta = (r_val - q_val - v2 / 2) / (2 * dx);
+	double l = alpha - beta;
+	double d = -2 * alpha - r_val;
+	double u = alpha + beta;
+
+	std::size_t n = N - 1;									//interior unknowns, V[1] .. V[N - 1]
+	double* x = V + 1;
+	const double* floor = payoff + 1;
+
+	double a = 0, b = 0, c = 0;								//constant tridiagonal system a x[i-1] + b x[i] + c x[i+1]
+	double factored_theta = -1, factored_h = -1;
+
+	auto factor = [&](double theta, double h)				//elimination coefficients only depend on the scheme, not on the values
+	{
+		if (theta == factored_theta && h == factored_h)
+			return;
+		factored_theta = theta;
+		factored_h = h;
+
+		a = -theta * h * l;
+		b = 1 - theta * h * d;
+		c = -theta * h * u;
+
+		if (sgn > 0)										//call: exercise at high S, eliminate upwards
+		{
+			mi[0] = 1 / b;
+			cp[0] = c * mi[0];
+			for (std::size_t i = 1; i < n; i++)
+			{
+				mi[i] = 1 / (b - a * cp[i - 1]);
+				cp[i] = c * mi[i];
+			}
+		}
+		else												//put: exercise at low S, eliminate downwards
+		{
+			mi[n - 1] = 1 / b;
+			cp[n - 1] = a * mi[n - 1];
+			for (std::size_t i = n - 1; i-- > 0;)
+			{
+				mi[i] = 1 / (b - c * cp[i + 1]);
+				cp[i] = a * mi[i];
+			}
+		}
+	};
+
+	auto step = [&](double theta, double h, double tau)		//one theta-scheme step ending at time to maturity tau
+	{
+		double lo = sgn < 0 ? K_val * std::exp(-r_val * tau) - S[0] * std::exp(-q_val * tau) : 0.0;
+		double hi = sgn > 0 ? S[N] * std::exp(-q_val * tau) - K_val * std::exp(-r_val * tau) : 0.0;
+		if (american)
+		{
+			lo = std::max(lo, payoff[0]);
+			hi = std::max(hi, payoff[N]);
+		}
+
+		factor(theta, h);
+
+		double e = (1 - theta) * h;
+		for (std::size_t i = 1; i < N; i++)
+			rhs[i - 1] = V[i] + e * (l * V[i - 1] + d * V[i] + u * V[i + 1]);
+
+		rhs[0] -= a * lo;
+		rhs[n - 1] -= c * hi;
+		V[0] = lo;
+		V[N] = hi;
+
+		if (sgn > 0)										//Brennan-Schwartz: the floor is applied while substituting
+		{													//back towards the continuation region
+			dp[0] = rhs[0] * mi[0];
+			for (std::size_t i = 1; i < n; i++)
+				dp[i] = (rhs[i] - a * dp[i - 1]) * mi[i];
+
+			x[n - 1] = dp[n - 1];
+			if (american)
+				x[n - 1] = std::max(x[n - 1], floor[n - 1]);
+			for (std::size_t i = n - 1; i-- > 0;)
+			{
+				x[i] = dp[i] - cp[i] * x[i + 1];
+				if (american)
+					x[i] = std::max(x[i], floor[i]);
+			}
+		}
+		else
+		{
+			dp[n - 1] = rhs[n - 1] * mi[n - 1];
+			for (std::size_t i = n - 1; i-- > 0;)
+				dp[i] = (rhs[i] - c * dp[i + 1]) * mi[i];
+
+			x[0] = dp[0];
+			if (american)
+				x[0] = std::max(x[0], floor[0]);
+			for (std::size_t i = 1; i < n; i++)
+			{
+				x[i] = dp[i] - cp[i] * x[i - 1];
+				if (american)
+					x[i] = std::max(x[i], floor[i]);
+			}
+		}
+	};
+
+	double dt = T_val / M;
+	for (std::size_t k = 0; k < M; k++)
+	{
+		if (k < grid_val.rannacher)
+		{
+			step(1, dt / 2, k * dt + dt / 2);
+			step(1, dt / 2, (k + 1) * dt);
+		}
+		else
+			step(0.5, dt, (k + 1) * dt);
+	}
+
+	return V[N / 2];
+}
+
+//Option prices
+double AmericanOption::Call() const
+{
+	static thread_local FDWorkspace ws;
+	return solve(true, ws);
+}
+
+double AmericanOption::Put() const
+{
+	static thread_local FDWorkspace ws;
+	return solve(false, ws);
+}
+
+double AmericanOption::Call(FDWorkspace& ws) const { return solve(true, ws); }
+double AmericanOption::Put(FDWorkspace& ws) const { return solve(false, ws); }
+
+void AmericanOption::SolveMany(const AmericanOption* options, double* out, std::size_t n, unsigned threads)
+{
+	auto sweep = [&](std::size_t from, std::size_t to)			//one workspace per thread
+	{
+		FDWorkspace ws;
+		for (std::size_t i = from; i < to; i++)
+			out[i] = options[i].solve(options[i].type() == 'C', ws);
+	};
+
+	split_rows(n, threads, sweep);
+}
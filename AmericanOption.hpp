@@ -0,0 +1,124 @@
+//A finite maturity american option class priced by a Crank-Nicolson finite difference engine
+//
+//The B-S PDE is solved in x = log(S) on a uniform grid centred on the spot (S sits on the middle node,
+//the grid is stretched slightly so the strike falls on a node too). Each time step is a constant
+//coefficient tridiagonal system solved in linear time by the Thomas algorithm. Early exercise is
+//handled by the Brennan-Schwartz method: the elimination runs away from the exercise region and the
+//payoff floor is applied during back substitution, which gives the exact American solution of the
+//discrete problem with a single sweep (no PSOR iterations). The first steps are Rannacher smoothed
+//(each replaced by two implicit Euler half steps) to damp the oscillations CN produces at the payoff kink.
+//
+//All scratch arrays live in an FDWorkspace that only grows, Call()/Put() use one per thread, so
+//repeated solves don't allocate. With FDGrid::american = false the engine converges to EuropeanOption.
+//
+//Accuracy/speed (S = K = 100, T = 1, r = 0.05, q = 0.02, vol = 0.3 american put, error against an
+//8000 x 8000 grid, one core, -O2):
+//
+//	space x time		abs. error		time per solve
+//	  50 x   25			7.0e-2			  20 us
+//	 100 x   50			1.9e-2			  79 us
+//	 200 x  100			5.3e-3			 270 us
+//	 400 x  200			1.6e-3			1040 us
+//	 800 x  400			4.8e-4			4300 us
+//
+//Doubling both dimensions costs 4x the time for about 3.5x less error (early exercise makes it a bit
+//worse than second order), without early exercise the error is second order in the space step.
+//
+//The grid spans +-width standard deviations, so the step grows with vol * sqrt(T): 200 space steps
+//reach FDGrid::max_dx = 0.05 at vol * sqrt(T) = 1, beyond it space_steps grows to keep dx (up to 65536
+//steps). American call S = K = 100, r = 0.05, q = 0, which has to equal the european price:
+//
+//	vol * sqrt(T)		space steps		abs. error		time per solve
+//	  2 (T = 4, vol = 1)	 400			3.8e-2			 480 us
+//	 11 (T = 30, vol = 2)	2192			1.8e-1			2700 us
+//
+//The error falls with max_dx^2 (0.025: 5.3e-2 at T = 30, vol = 2); with a fixed 200 steps that
+//contract had dx = 0.55 and an error of 10.8.
+
+#include "Option.hpp"
+#include <cstddef>
+#include <iostream>
+#include <vector>
+
+#ifndef American_Option_HPP
+#define American_Option_HPP
+
+struct FDGrid
+{
+	std::size_t space_steps = 200;				//intervals in log(S), rounded up to an even number
+	std::size_t time_steps = 100;
+	double width = 5;							//half width of the grid in standard deviations (vol * sqrt(T))
+	double max_dx = 0.05;						//largest step in log(S), more space steps (up to 65536) keep it (0 - no cap)
+	std::size_t rannacher = 2;					//first CN steps replaced by implicit Euler half steps
+	bool american = true;						//false - no early exercise
+};
+
+class FDWorkspace								//scratch arrays of one solve, reusable across solves
+{
+private:
+	friend class AmericanOption;
+
+	std::vector<double> V;						//option values on the grid
+	std::vector<double> S;						//spot at every node
+	std::vector<double> payoff;
+	std::vector<double> rhs;
+	std::vector<double> c_prime;				//Thomas algorithm scratch
+	std::vector<double> d_prime;
+	std::vector<double> m_inv;					//inverse pivots, shared by all steps of the same scheme
+
+	void resize(std::size_t nodes);				//only grows
+};
+
+class AmericanOption : public Option
+{
+private:
+	double S_val = 0;							//option pricing parameters
+	double K_val = 0;
+	double T_val = 1;
+	double r_val = 0.05;
+	double vol_val = 0.3;
+	double q_val = 0;							//continuous dividend yield
+	FDGrid grid_val;
+
+	double solve(bool call, FDWorkspace& ws) const;
+
+public:
+	//Constructors and destructor
+	AmericanOption();
+	AmericanOption(const AmericanOption& o);
+	virtual ~AmericanOption();
+
+	//Selectors
+	double S() const;
+	double K() const;
+	double T() const;
+	double r() const;
+	double vol() const;
+	double q() const;
+	const FDGrid& grid() const;
+
+	//Modifiers
+	void S(double newS);
+	void K(double newK);
+	void T(double newT);
+	void r(double newr);
+	void vol(double newvol);
+	void q(double newq);
+	void grid(const FDGrid& newgrid);
+	void SetValues(const std::vector<double>& params);//set values from a vector of parameters (S, K, T, r, vol and optional q)
+	void SetValues(const double* params, std::size_t count);//same from a plain array (used by matrix_eval)
+
+	//Operator overloading
+	AmericanOption& operator=(const AmericanOption& src);
+
+	//Option prices
+	double Call() const;						//get price for call option (thread local workspace)
+	double Put() const;							//get price for put option
+	double Call(FDWorkspace& ws) const;			//same with a caller-owned workspace
+	double Put(FDWorkspace& ws) const;
+
+	//Price n options according to their types, split between threads (0 - all hardware threads)
+	static void SolveMany(const AmericanOption* options, double* out, std::size_t n, unsigned threads = 1);
+};
+
+#endif
@@ -0,0 +1,548 @@
+//File batch mode of the CLI: memory-mapped, chunked, multithreaded and order-preserving
+
+#include "BatchFile.hpp"
+#include "BatchPricing.hpp"
+#include "EuropeanOption.hpp"
+#include "PerpetualBatch.hpp"
+#include "Stats.hpp"
+#include <algorithm>
+#include <charconv>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+	struct Chunk												//a piece of the input together with its priced output
+	{
+		const char* begin = nullptr;							//whole lines of the mapped input
+		const char* end = nullptr;
+		std::size_t first = 1;									//line number of the first line
+		std::size_t lines = 0;
+		std::size_t priced = 0;
+		std::size_t errors = 0;
+		std::string output;										//reused between chunks, grows to the largest chunk once
+		std::string messages;									//parse error reports
+		std::vector<double> columns[5];							//parsed rows, S K T r vol (perpetual mode: S K r b vol)
+		std::vector<std::size_t> rows;							//their line numbers
+		std::vector<std::pair<const char*, const char*>> text;	//and text, for the rejects stream
+		std::vector<InputValidation::Status> status;			//validation result per parsed row
+		InputValidation::Report validation;
+		std::string rejected;									//lines that weren't priced, verbatim
+		std::size_t aborted_line = 0;
+		InputValidation::Status aborted_status = 0;
+		std::vector<double> call, put;
+		std::vector<float> single[5];							//float copy of the columns for the single precision mode
+		std::vector<float> single_call, single_put;
+		bool done = false;
+	};
+
+	inline bool is_blank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+	void append_uint(std::string& buf, std::size_t v)
+	{
+		char tmp[24];
+		char* e = std::to_chars(tmp, tmp + sizeof(tmp), v).ptr;
+		buf.append(tmp, e - tmp);
+	}
+
+	void report(Chunk& chunk, std::size_t line, const char* why)
+	{
+		chunk.messages += "line ";
+		append_uint(chunk.messages, line);
+		chunk.messages += ": ";
+		chunk.messages += why;
+		chunk.messages += '\n';
+		chunk.errors++;
+	}
+
+	void reset(Chunk& chunk)
+	{
+		chunk.output.clear();
+		chunk.messages.clear();
+		chunk.rejected.clear();
+		chunk.priced = 0;
+		chunk.errors = 0;
+		chunk.rows.clear();
+		chunk.text.clear();
+		chunk.aborted_line = 0;
+		chunk.aborted_status = 0;
+		for (std::vector<double>& c : chunk.columns)
+			c.clear();
+	}
+
+	void keep_text(std::string& buf, const char* begin, const char* end)	//one input line, without the line break
+	{
+		if (end > begin && end[-1] == '\r')
+			end--;
+		buf.append(begin, end - begin);
+		buf += '\n';
+	}
+
+	void reject_from_row(Chunk& chunk, std::size_t kept)	//Abort: the unpriced lines before row kept, then every line from it on
+	{
+		const char* from = chunk.text[kept].first;
+		std::size_t j = 0;
+		chunk.rejected.clear();
+
+		for (const char* p = chunk.begin; p < chunk.end;)
+		{
+			const char* eol = (const char*)memchr(p, '\n', chunk.end - p);
+			if (!eol)
+				eol = chunk.end;
+
+			if (p < from && j < kept && p == chunk.text[j].first)	//one of the priced rows
+				j++;
+			else
+				keep_text(chunk.rejected, p, eol);
+
+			p = eol + 1;
+		}
+	}
+
+	void reject_input(const char* p, const char* end, std::ostream& rejects)	//Abort: the input after the aborted chunk
+	{
+		std::string buf;
+		while (p < end)
+		{
+			const char* eol = (const char*)memchr(p, '\n', end - p);
+			if (!eol)
+				eol = end;
+			keep_text(buf, p, eol);
+			p = eol + 1;
+
+			if (buf.size() >= (1 << 20) || p >= end)
+			{
+				rejects.write(buf.data(), buf.size());
+				buf.clear();
+			}
+		}
+	}
+
+	template<typename Store>
+	void parse_chunk(Chunk& chunk, const BatchFileOptions& options, Store store)	//parse every line, store(params) keeps the valid ones
+	{
+		Stats::ScopedTimer timer(Stats::Parse, chunk.lines);
+		double params[5];
+		std::size_t line = chunk.first;
+
+		for (const char* p = chunk.begin; p < chunk.end; line++)
+		{
+			const char* eol = (const char*)memchr(p, '\n', chunk.end - p);
+			if (!eol)
+				eol = chunk.end;
+
+			if (const char* why = ParseQuoteLine(p, eol, params, options.perpetual))
+			{
+				report(chunk, line, why);
+				if (options.rejects)
+					keep_text(chunk.rejected, p, eol);
+			}
+			else
+			{
+				store(params);
+				chunk.rows.push_back(line);
+				chunk.text.emplace_back(p, eol);
+			}
+
+			p = eol + 1;
+		}
+	}
+
+	//Validation pass over the parsed columns (S, K, then T r vol or r b vol), then the policy: Clamp has
+	//already fixed the columns, Reject drops the bad rows, Abort keeps only the rows before the first bad one
+	void validate(Chunk& chunk, const BatchFileOptions& options, bool perpetual)
+	{
+		std::vector<double>* c = chunk.columns;
+		std::size_t n = chunk.rows.size();
+		chunk.status.resize(n);
+
+		if (perpetual)
+			chunk.validation = InputValidation::Perpetual(c[0].data(), c[1].data(), c[2].data(), c[3].data(), c[4].data(),
+														  chunk.status.data(), n, options.policy);
+		else
+			chunk.validation = InputValidation::European(c[0].data(), c[1].data(), c[2].data(), c[3].data(), c[4].data(),
+														 chunk.status.data(), n, options.policy);
+
+		if (!chunk.validation.invalid || options.policy == InputValidation::Policy::Clamp)
+			return;
+
+		std::size_t kept = 0;
+		if (options.policy == InputValidation::Policy::Abort)
+		{
+			kept = chunk.validation.first_invalid;
+			chunk.aborted_line = chunk.rows[kept];
+			chunk.aborted_status = chunk.status[kept];
+			if (options.rejects)
+				reject_from_row(chunk, kept);
+		}
+		else
+			for (std::size_t i = 0; i < n; i++)					//compact the surviving rows in place
+			{
+				if (chunk.status[i])
+				{
+					if (options.rejects)
+						keep_text(chunk.rejected, chunk.text[i].first, chunk.text[i].second);
+					continue;
+				}
+				for (int j = 0; j < 5; j++)
+					c[j][kept] = c[j][i];
+				chunk.rows[kept] = chunk.rows[i];
+				kept++;
+			}
+
+		for (int j = 0; j < 5; j++)
+			c[j].resize(kept);
+		chunk.rows.resize(kept);
+	}
+
+	template<typename F>
+	void write_rows(Chunk& chunk, const F* call, const F* put)	//format the results of the stored rows
+	{
+		std::size_t n = chunk.rows.size();
+		Stats::ScopedTimer timer(Stats::Format, n);
+		for (std::size_t i = 0; i < n; i++)
+			AppendResultLine(chunk.output, chunk.rows[i], call[i], put[i]);
+		chunk.priced = n;
+	}
+
+	void price_chunk_perpetual(Chunk& chunk, const BatchFileOptions& options)	//"K vol r b S" lines: parse the whole chunk, then price it in one batch
+	{
+		reset(chunk);
+		parse_chunk(chunk, options, [&](const double* params) {
+			chunk.columns[0].push_back(params[4]);				//S K r b vol
+			chunk.columns[1].push_back(params[0]);
+			chunk.columns[2].push_back(params[2]);
+			chunk.columns[3].push_back(params[3]);
+			chunk.columns[4].push_back(params[1]);
+		});
+		validate(chunk, options, true);
+
+		std::size_t n = chunk.rows.size();
+		chunk.call.resize(n);
+		chunk.put.resize(n);
+		{
+			Stats::ScopedTimer timer(Stats::Price, n);
+			PerpetualBatch::CallPut(chunk.columns[0].data(), chunk.columns[1].data(), chunk.columns[2].data(),
+									chunk.columns[3].data(), chunk.columns[4].data(), chunk.call.data(), chunk.put.data(), n);
+		}
+		write_rows(chunk, chunk.call.data(), chunk.put.data());
+	}
+
+	void parse_european(Chunk& chunk, const BatchFileOptions& options)	//"T K vol r S" lines into validated S K T r vol columns
+	{
+		parse_chunk(chunk, options, [&](const double* params) {
+			chunk.columns[0].push_back(params[4]);
+			chunk.columns[1].push_back(params[1]);
+			chunk.columns[2].push_back(params[0]);
+			chunk.columns[3].push_back(params[3]);
+			chunk.columns[4].push_back(params[2]);
+		});
+		validate(chunk, options, false);
+	}
+
+	void price_chunk_single(Chunk& chunk, const BatchFileOptions& options)	//european lines priced in one float batch
+	{
+		reset(chunk);
+		parse_european(chunk, options);
+
+		std::size_t n = chunk.rows.size();
+		chunk.single_call.resize(n);
+		chunk.single_put.resize(n);
+		{
+			Stats::ScopedTimer timer(Stats::Price, n);
+			for (int j = 0; j < 5; j++)
+				chunk.single[j].assign(chunk.columns[j].begin(), chunk.columns[j].end());
+			BatchPricing::CallPut(chunk.single[0].data(), chunk.single[1].data(), chunk.single[2].data(), chunk.single[3].data(),
+								  chunk.single[4].data(), chunk.single_call.data(), chunk.single_put.data(), n);
+		}
+		write_rows(chunk, chunk.single_call.data(), chunk.single_put.data());
+	}
+
+	void price_chunk(Chunk& chunk, const BatchFileOptions& options)	//parse and price every line of the chunk into its output buffer
+	{
+		if (options.perpetual)
+		{
+			price_chunk_perpetual(chunk, options);
+			return;
+		}
+		if (options.single_precision)
+		{
+			price_chunk_single(chunk, options);
+			return;
+		}
+
+		reset(chunk);
+		parse_european(chunk, options);
+
+		std::size_t n = chunk.rows.size();
+		PriceCache* cache = options.cache;
+		EuropeanOption opt;
+		chunk.call.resize(n);
+		chunk.put.resize(n);
+
+		{
+			Stats::ScopedTimer timer(Stats::Price, n);
+			for (std::size_t i = 0; i < n; i++)
+			{
+				double params[5] = { chunk.columns[0][i], chunk.columns[1][i], chunk.columns[2][i],
+									 chunk.columns[3][i], chunk.columns[4][i] };
+
+				if (cache)										//look up the validated values
+				{
+					double clamped[5] = { params[2], params[1], params[4], params[3], params[0] };
+					BlackScholesResult res = cache->Get(clamped);
+					chunk.call[i] = res.call;
+					chunk.put[i] = res.put;
+				}
+				else
+				{
+					opt.SetValues(params, 5);					//already validated
+					chunk.call[i] = opt.Call();
+					chunk.put[i] = opt.Put();
+				}
+			}
+		}
+
+		write_rows(chunk, chunk.call.data(), chunk.put.data());
+	}
+
+	class WorkerPool											//fixed set of threads pricing chunks from a queue
+	{
+	private:
+		std::vector<std::thread> workers;
+		std::queue<Chunk*> jobs;
+		std::mutex m;
+		std::condition_variable job_ready;
+		std::condition_variable job_done;
+		bool stopping = false;
+		BatchFileOptions options;
+
+		void run()
+		{
+			while (true)
+			{
+				Chunk* chunk;
+				{
+					std::unique_lock<std::mutex> lock(m);
+					job_ready.wait(lock, [this] { return stopping || !jobs.empty(); });
+					if (jobs.empty())
+						return;
+					chunk = jobs.front();
+					jobs.pop();
+				}
+
+				price_chunk(*chunk, options);
+
+				{
+					std::lock_guard<std::mutex> lock(m);
+					chunk->done = true;
+				}
+				job_done.notify_all();
+			}
+		}
+
+	public:
+		WorkerPool(unsigned threads, const BatchFileOptions& options) : options(options)
+		{
+			for (unsigned i = 0; i < threads; i++)
+				workers.emplace_back(&WorkerPool::run, this);
+		}
+
+		~WorkerPool()
+		{
+			{
+				std::lock_guard<std::mutex> lock(m);
+				stopping = true;
+			}
+			job_ready.notify_all();
+			for (std::thread& t : workers)
+				t.join();
+		}
+
+		void submit(Chunk* chunk)
+		{
+			{
+				std::lock_guard<std::mutex> lock(m);
+				chunk->done = false;
+				jobs.push(chunk);
+			}
+			job_ready.notify_one();
+		}
+
+		void wait(Chunk* chunk)
+		{
+			std::unique_lock<std::mutex> lock(m);
+			job_done.wait(lock, [chunk] { return chunk->done; });
+		}
+	};
+
+	class ChunkReader											//cuts the mapped input into chunks of whole lines
+	{
+	private:
+		const char* p;
+		const char* end;
+		std::size_t chunk_bytes;
+		std::size_t line = 1;
+
+	public:
+		ChunkReader(const char* data, std::size_t size, std::size_t bytes)
+			:p(data), end(data + size), chunk_bytes(bytes ? bytes : 1)
+		{
+		}
+
+		bool next(Chunk& chunk)
+		{
+			if (p >= end)
+				return false;
+
+			const char* stop = p + std::min(chunk_bytes, (std::size_t)(end - p));
+			const char* eol = (const char*)memchr(stop - 1, '\n', end - (stop - 1));
+			stop = eol ? eol + 1 : end;
+
+			chunk.begin = p;
+			chunk.end = stop;
+			chunk.first = line;
+			chunk.lines = std::count(p, stop, '\n') + (stop[-1] != '\n');
+
+			line += chunk.lines;
+			p = stop;
+			return true;
+		}
+	};
+
+	bool flush(const Chunk& chunk, std::ostream& out, std::ostream& err, const BatchFileOptions& options,
+			   BatchFileResult& res, const char* input_end)				//false once a chunk was aborted by validation
+	{
+		{
+			Stats::ScopedTimer timer(Stats::Write, chunk.output.size());
+			out.write(chunk.output.data(), chunk.output.size());
+		}
+		if (!chunk.messages.empty())
+			err << chunk.messages;
+		if (options.rejects && !chunk.rejected.empty())
+			options.rejects->write(chunk.rejected.data(), chunk.rejected.size());
+		if (options.rejects && chunk.aborted_line)				//nothing after the aborted row is priced
+			reject_input(chunk.end, input_end, *options.rejects);
+
+		res.lines += chunk.lines;
+		res.priced += chunk.priced;
+		res.errors += chunk.errors;
+		res.validation.Add(chunk.validation);
+		res.aborted_line = chunk.aborted_line;
+		res.aborted_status = chunk.aborted_status;
+		return chunk.aborted_line == 0;
+	}
+
+}
+
+void AppendFixed(std::string& buf, double v)
+{
+	char tmp[512];
+	std::to_chars_result res = std::to_chars(tmp, tmp + sizeof(tmp), v, std::chars_format::fixed, 6);
+	buf.append(tmp, res.ptr - tmp);
+}
+
+void AppendResultLine(std::string& buf, std::size_t n, double call, double put)
+{
+	static const char prefix[] = "Option #";
+	static const char call_text[] = ": Call = ";
+	static const char put_text[] = ", Put = ";
+
+	buf.append(prefix, sizeof(prefix) - 1);
+	append_uint(buf, n);
+	buf.append(call_text, sizeof(call_text) - 1);
+	AppendFixed(buf, call);
+	buf.append(put_text, sizeof(put_text) - 1);
+	AppendFixed(buf, put);
+	buf += '\n';
+}
+
+const char* ParseQuoteLine(const char* begin, const char* end, double (&params)[5], bool perpetual)
+{
+	const char* p = begin;
+
+	for (int i = 0; i < 5; i++)
+	{
+		while (p < end && is_blank(*p))
+			p++;
+
+		if (p == end)
+			return perpetual ? "expected 5 values (K vol r b S)" : "expected 5 values (T K vol r S)";
+
+		if (*p == '+')											//from_chars doesn't take an explicit plus sign
+			p++;
+
+		std::from_chars_result res = std::from_chars(p, end, params[i]);
+		if (res.ec != std::errc() || (res.ptr < end && !is_blank(*res.ptr)))
+			return "not a number";
+
+		p = res.ptr;
+	}
+
+	return nullptr;												//anything after the fifth value is ignored
+}
+
+BatchFileResult PriceTextFile(const char* data, std::size_t size, std::ostream& out, std::ostream& err,
+							  const BatchFileOptions& options)
+{
+	unsigned threads = options.threads;
+	if (threads == 0)
+		threads = std::thread::hardware_concurrency();
+	if (threads == 0)
+		threads = 1;
+
+	ChunkReader reader(data, size, options.chunk_bytes);
+	BatchFileResult res;
+
+	if (threads == 1)											//single thread - no need for the pool
+	{
+		Chunk chunk;
+		while (reader.next(chunk))
+		{
+			price_chunk(chunk, options);
+			if (!flush(chunk, out, err, options, res, data + size))
+				break;
+		}
+		return res;
+	}
+
+	std::vector<Chunk> slots(2 * threads);						//ring of chunks, slot i is reused for chunk i, i + slots.size(), ...
+	WorkerPool pool(threads, options);
+
+	std::size_t submitted = 0;
+	std::size_t written = 0;
+
+	while (true)
+	{
+		Chunk& slot = slots[submitted % slots.size()];
+
+		if (submitted - written == slots.size())				//every slot is busy - write out the oldest chunk first
+		{
+			pool.wait(&slot);
+			written++;
+			if (!flush(slot, out, err, options, res, data + size))
+				return res;										//chunks still queued are finished by the pool and dropped
+		}
+
+		if (!reader.next(slot))
+			break;
+
+		pool.submit(&slot);
+		submitted++;
+	}
+
+	for (; written < submitted; written++)						//drain the chunks still in flight in order
+	{
+		Chunk& slot = slots[written % slots.size()];
+		pool.wait(&slot);
+		if (!flush(slot, out, err, options, res, data + size))
+			break;
+	}
+
+	return res;
+}
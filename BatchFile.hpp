@@ -0,0 +1,63 @@
+//File batch mode of the CLI: prices every "T K vol r S" line of an input buffer and writes
+//"Option #n: Call = ..., Put = ..." lines in the original order
+//
+//The input is a memory-mapped file, numbers are parsed in place with std::from_chars and results
+//are formatted with std::to_chars into per-chunk output buffers that are reused and written out
+//in large blocks. Chunks are priced on a pool of worker threads and written back in order by the
+//calling thread. At most 2 * threads chunks are in flight at any time, so memory use doesn't
+//depend on the file size.
+//
+//With BatchFileOptions::perpetual the lines are "K vol r b S" and are priced with PerpetualBatch.
+//With BatchFileOptions::single_precision european lines are priced by the float batch path of BatchPricing
+//(error bounds in BatchPricing.hpp).
+//
+//Lines that can't be parsed are reported as "line n: reason" on the error stream and skipped,
+//option numbers always follow input line numbers. Parsed rows go through an InputValidation pass per
+//chunk before pricing, with BatchFileOptions::policy deciding what happens to rows with negative or
+//non-finite inputs; nothing is printed per row, the counts end up in BatchFileResult::validation.
+//Lines that weren't priced (parse errors and rejected rows) can be copied verbatim to a side stream.
+
+#include "InputValidation.hpp"
+#include "PriceCache.hpp"
+#include <cstddef>
+#include <ostream>
+#include <string>
+
+#ifndef Batch_File_HPP
+#define Batch_File_HPP
+
+struct BatchFileOptions
+{
+	unsigned threads = 1;						//worker threads (0 - use all hardware threads)
+	std::size_t chunk_bytes = 1 << 20;			//approximate input bytes per chunk handed to a worker
+	PriceCache* cache = nullptr;				//optional result cache shared by all workers, owned by the caller
+	bool perpetual = false;						//lines are "K vol r b S" of perpetual american options (the cache is not used)
+	bool single_precision = false;				//price european lines in float (the cache is not used)
+	InputValidation::Policy policy = InputValidation::Policy::Clamp;	//rows with invalid inputs
+	std::ostream* rejects = nullptr;			//optional side stream for the lines that weren't priced (Abort: up to the end)
+};
+
+struct BatchFileResult
+{
+	std::size_t lines = 0;						//lines read
+	std::size_t priced = 0;						//lines priced and written
+	std::size_t errors = 0;						//lines rejected by the parser
+	InputValidation::Report validation;			//rows of all chunks that were validated
+	std::size_t aborted_line = 0;				//line of the row that stopped the Abort policy (0 - not aborted)
+	InputValidation::Status aborted_status = 0;	//and its bad fields
+};
+
+//Price all lines of [data, data + size) and write results to out, parse errors go to err
+BatchFileResult PriceTextFile(const char* data, std::size_t size, std::ostream& out, std::ostream& err,
+							  const BatchFileOptions& options);
+
+//Parse five numbers ("T K vol r S", or "K vol r b S" if perpetual) at the start of [begin, end), returns nullptr on success or the reason of failure
+const char* ParseQuoteLine(const char* begin, const char* end, double (&params)[5], bool perpetual = false);
+
+//Append "Option #n: Call = ..., Put = ...\n" to buf without temporary strings
+void AppendResultLine(std::string& buf, std::size_t n, double call, double put);
+
+//Append v in printf "%f" format (same text as std::to_string)
+void AppendFixed(std::string& buf, double v);
+
+#endif
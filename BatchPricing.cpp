@@ -0,0 +1,201 @@
+//Structure-of-arrays batch pricing for plain european options
+
+#include "BatchPricing.hpp"
+#include "OptionProbability.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace BatchPricing {
+
+	namespace {
+
+		//d1, d2 and discounted strike for one block, flat loop over contiguous columns
+		template<typename F>
+		void block_terms(const F* S, const F* K, const F* T, const F* r, const F* vol, F* d1, F* d2, F* DK, std::size_t m)
+		{
+			for (std::size_t i = 0; i < m; i++)
+			{
+				F vsT = vol[i] * std::sqrt(T[i]);
+				d1[i] = (std::log(S[i] / K[i]) + (r[i] + vol[i] * vol[i] / 2) * T[i]) / vsT;
+				d2[i] = d1[i] - vsT;
+				DK[i] = K[i] * std::exp(-r[i] * T[i]);
+			}
+		}
+
+		template<typename F>
+		void block_cdf(F* x, std::size_t m)			//replace every element with N(x) in place, SIMD kernels
+		{
+			OptionProbability::N(x, x, m);
+		}
+
+		template<typename F>
+		void block_cdf_pair(F* x, F* upper, std::size_t m)	//x becomes N(x) and upper gets N(-x)
+		{
+			OptionProbability::N_pair(x, x, upper, m);
+		}
+
+		template<typename F>
+		void prices(const F* S, const F* K, const F* T, const F* r, const F* vol, const char* type, F* out, std::size_t n)
+		{
+			F d1[block];
+			F d2[block];
+			F DK[block];
+			F sgn[block];
+
+			for (std::size_t start = 0; start < n; start += block)
+			{
+				std::size_t m = std::min(block, n - start);
+
+				block_terms(S + start, K + start, T + start, r + start, vol + start, d1, d2, DK, m);
+
+				for (std::size_t i = 0; i < m; i++)		//put = -(S N(-d1) - DK N(-d2)), so flip signs per row
+				{
+					sgn[i] = (type[start + i] == 'C') ? F(1) : F(-1);
+					d1[i] *= sgn[i];
+					d2[i] *= sgn[i];
+				}
+
+				block_cdf(d1, m);
+				block_cdf(d2, m);
+
+				for (std::size_t i = 0; i < m; i++)
+					out[start + i] = sgn[i] * (S[start + i] * d1[i] - DK[i] * d2[i]);
+			}
+		}
+
+		template<typename F>
+		void call_put(const F* S, const F* K, const F* T, const F* r, const F* vol, F* call, F* put, std::size_t n)
+		{
+			F d1[block];
+			F d2[block];
+			F DK[block];
+			F Nm1[block];
+			F Nm2[block];
+
+			for (std::size_t start = 0; start < n; start += block)
+			{
+				std::size_t m = std::min(block, n - start);
+
+				block_terms(S + start, K + start, T + start, r + start, vol + start, d1, d2, DK, m);
+
+				block_cdf_pair(d1, Nm1, m);				//N(d) and N(-d) share one CDF evaluation
+				block_cdf_pair(d2, Nm2, m);
+
+				for (std::size_t i = 0; i < m; i++)
+				{
+					call[start + i] = S[start + i] * d1[i] - DK[i] * d2[i];
+					put[start + i] = DK[i] * Nm2[i] - S[start + i] * Nm1[i];
+				}
+			}
+		}
+
+	}
+
+	void Prices(const double* S, const double* K, const double* T, const double* r, const double* vol,
+				const char* type, double* out, std::size_t n)
+	{
+		prices(S, K, T, r, vol, type, out, n);
+	}
+
+	void Prices(const float* S, const float* K, const float* T, const float* r, const float* vol,
+				const char* type, float* out, std::size_t n)
+	{
+		prices(S, K, T, r, vol, type, out, n);
+	}
+
+	void CallPut(const double* S, const double* K, const double* T, const double* r, const double* vol,
+				 double* call, double* put, std::size_t n)
+	{
+		call_put(S, K, T, r, vol, call, put, n);
+	}
+
+	void CallPut(const float* S, const float* K, const float* T, const float* r, const float* vol,
+				 float* call, float* put, std::size_t n)
+	{
+		call_put(S, K, T, r, vol, call, put, n);
+	}
+
+	void Greeks(const double* S, const double* K, const double* T, const double* r, const double* vol,
+				const GreekColumns& out, std::size_t n)
+	{
+		double d1[block];
+		double d2[block];
+		double DK[block];
+		double nd1[block];
+		double Nm1[block];
+		double Nm2[block];
+
+		for (std::size_t start = 0; start < n; start += block)
+		{
+			std::size_t m = std::min(block, n - start);
+			const double* s = S + start;
+			const double* t = T + start;
+			const double* v = vol + start;
+			const double* rr = r + start;
+
+			block_terms(s, K + start, t, rr, v, d1, d2, DK, m);
+
+			OptionProbability::n(d1, nd1, m);
+
+			block_cdf_pair(d1, Nm1, m);
+			block_cdf_pair(d2, Nm2, m);
+
+			for (std::size_t i = 0; i < m; i++)		//same formulas as black_scholes(), d1/d2 now hold N(d1)/N(d2)
+			{
+				std::size_t o = start + i;
+				double sqrtT = std::sqrt(t[i]);
+				double Snd1 = s[i] * nd1[i];
+				double decay = -Snd1 * v[i] / (2 * sqrtT);
+
+				out.call[o] = s[i] * d1[i] - DK[i] * d2[i];
+				out.put[o] = DK[i] * Nm2[i] - s[i] * Nm1[i];
+				out.delta_call[o] = d1[i];
+				out.delta_put[o] = -Nm1[i];
+				out.gamma[o] = nd1[i] / (s[i] * v[i] * sqrtT);
+				out.vega[o] = Snd1 * sqrtT;
+				out.theta_call[o] = decay - rr[i] * DK[i] * d2[i];
+				out.theta_put[o] = decay + rr[i] * DK[i] * Nm2[i];
+				out.rho_call[o] = t[i] * DK[i] * d2[i];
+				out.rho_put[o] = -t[i] * DK[i] * Nm2[i];
+			}
+		}
+	}
+
+	//EuropeanBatch
+
+	void EuropeanBatch::reserve(std::size_t n)
+	{
+		S.reserve(n);
+		K.reserve(n);
+		T.reserve(n);
+		r.reserve(n);
+		vol.reserve(n);
+		type.reserve(n);
+	}
+
+	void EuropeanBatch::add(double newS, double newK, double newT, double newr, double newvol, char newtype)
+	{
+		S.push_back(newS);
+		K.push_back(newK);
+		T.push_back(newT);
+		r.push_back(newr);
+		vol.push_back(newvol);
+		type.push_back(newtype);
+	}
+
+	void EuropeanBatch::Prices(double* out) const
+	{
+		BatchPricing::Prices(S.data(), K.data(), T.data(), r.data(), vol.data(), type.data(), out, size());
+	}
+
+	void EuropeanBatch::CallPut(double* call, double* put) const
+	{
+		BatchPricing::CallPut(S.data(), K.data(), T.data(), r.data(), vol.data(), call, put, size());
+	}
+
+	void EuropeanBatch::Greeks(const GreekColumns& out) const
+	{
+		BatchPricing::Greeks(S.data(), K.data(), T.data(), r.data(), vol.data(), out, size());
+	}
+
+}
@@ -0,0 +1,84 @@
+//Structure-of-arrays batch pricing for plain european options
+//
+//Inputs are contiguous parameter columns (one array per B-S parameter) and outputs are written
+//into caller-provided arrays, so a whole chain is priced without creating EuropeanOption objects.
+//Work is done in fixed-size blocks: d1/d2/discount factors, CDFs and the final combination are
+//separate flat loops over the block which the compiler can vectorize.
+//
+//Values are used as given (no clamping like EuropeanOption setters do), results agree with the
+//scalar EuropeanOption::Call()/Put() path within BatchPricing::tolerance (absolute, per unit of S + K).
+
+#include <cstddef>
+#include <vector>
+
+#ifndef Batch_Pricing_HPP
+#define Batch_Pricing_HPP
+
+namespace BatchPricing {
+
+	static const double tolerance = 1e-13;			//max |batch - scalar| / (S + K) in double precision
+	//Single precision against double on S, K in [50, 150], T in [0.01, 3], r in [0, 0.1], vol in [0.05, 0.8]
+	//(1M random contracts): max abs error 3.1e-5, 1.5e-7 per unit of S + K, relative error 6.1e-5 for prices
+	//of at least 1e-4 (S + K). Cheaper out of the money prices lose relative accuracy to the cancellation
+	//in S N(d1) - DK N(d2), so the float path is meant for screening, not for quoting deep OTM contracts.
+	static const double float_tolerance = 5e-7;		//max |float batch - double batch| / (S + K)
+	static const double float_relative_tolerance = 5e-4;	//max relative error of prices >= float_relative_floor * (S + K)
+	static const double float_relative_floor = 1e-4;
+	static const std::size_t block = 256;			//number of contracts processed per inner block
+
+	//Price n options, type[i] is 'C' or 'P' (same convention as Option::type())
+	void Prices(const double* S, const double* K, const double* T, const double* r, const double* vol,
+				const char* type, double* out, std::size_t n);
+
+	//Both call and put prices of n options
+	void CallPut(const double* S, const double* K, const double* T, const double* r, const double* vol,
+				 double* call, double* put, std::size_t n);
+
+	//Single precision versions for screening and scenario work, the CDF kernels process twice as many
+	//values per instruction (see the error bounds above and bench/batch-pricing.cpp)
+	void Prices(const float* S, const float* K, const float* T, const float* r, const float* vol,
+				const char* type, float* out, std::size_t n);
+	void CallPut(const float* S, const float* K, const float* T, const float* r, const float* vol,
+				 float* call, float* put, std::size_t n);
+
+	//Caller-provided output columns for Greeks(), every pointer must have room for n values
+	struct GreekColumns
+	{
+		double* call;
+		double* put;
+		double* delta_call;
+		double* delta_put;
+		double* gamma;
+		double* vega;
+		double* theta_call;
+		double* theta_put;
+		double* rho_call;
+		double* rho_put;
+	};
+
+	//Prices and greeks of n options in one sweep (see BlackScholes.hpp for the definitions)
+	void Greeks(const double* S, const double* K, const double* T, const double* r, const double* vol,
+				const GreekColumns& out, std::size_t n);
+
+	//Owning SoA container for a chain of contracts
+	struct EuropeanBatch
+	{
+		std::vector<double> S;
+		std::vector<double> K;
+		std::vector<double> T;
+		std::vector<double> r;
+		std::vector<double> vol;
+		std::vector<char> type;
+
+		std::size_t size() const { return S.size(); }
+		void reserve(std::size_t n);
+		void add(double newS, double newK, double newT, double newr, double newvol, char newtype = 'C');
+
+		void Prices(double* out) const;				//price every contract according to its type
+		void CallPut(double* call, double* put) const;
+		void Greeks(const GreekColumns& out) const;
+	};
+
+}
+
+#endif
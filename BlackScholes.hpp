@@ -0,0 +1,63 @@
+//Fused Black-Scholes kernel: prices and greeks of a european call/put pair from one set of intermediates
+//
+//d1, d2, the discount factor and the CDF/PDF values are computed once and reused by every output,
+//so asking for price + delta + gamma costs about as much as a single price.
+//Templated on the floating type, black_scholes() with float arguments runs entirely in single precision.
+
+#include "OptionProbability.hpp"
+#include <cmath>
+
+#ifndef Black_Scholes_HPP
+#define Black_Scholes_HPP
+
+template<typename F>
+struct BasicBlackScholesResult
+{
+	F call = 0;									//prices
+	F put = 0;
+	F delta_call = 0;							//dV/dS
+	F delta_put = 0;
+	F gamma = 0;								//d2V/dS2 (same for call and put)
+	F vega = 0;									//dV/dvol (same for call and put)
+	F theta_call = 0;							//dV/dt, per year
+	F theta_put = 0;
+	F rho_call = 0;								//dV/dr
+	F rho_put = 0;
+};
+
+typedef BasicBlackScholesResult<double> BlackScholesResult;
+
+template<typename F>
+inline BasicBlackScholesResult<F>
+black_scholes(F S, F K, F T, F r, F vol)
+{
+	using std::exp; using std::log; using std::sqrt;
+	BasicBlackScholesResult<F> res;
+
+	F sqrtT = sqrt(T);
+	F vsT = vol * sqrtT;
+	F d1 = (log(S / K) + (r + vol * vol / 2) * T) / vsT;
+	F d2 = d1 - vsT;
+	F DK = K * exp(-r * T);						//discounted strike
+
+	F Nd1, Nm1, Nd2, Nm2;						//N(d) and N(-d)
+	OptionProbability::N_pair(d1, Nd1, Nm1);
+	OptionProbability::N_pair(d2, Nd2, Nm2);
+	F nd1 = OptionProbability::n(d1);
+	F Snd1 = S * nd1;
+
+	res.call = S * Nd1 - DK * Nd2;
+	res.put = DK * Nm2 - S * Nm1;
+	res.delta_call = Nd1;
+	res.delta_put = -Nm1;
+	res.gamma = nd1 / (S * vsT);
+	res.vega = Snd1 * sqrtT;
+	res.theta_call = -Snd1 * vol / (2 * sqrtT) - r * DK * Nd2;
+	res.theta_put = -Snd1 * vol / (2 * sqrtT) + r * DK * Nm2;
+	res.rho_call = T * DK * Nd2;
+	res.rho_put = -T * DK * Nm2;
+
+	return res;
+}
+
+#endif
@@ -0,0 +1,278 @@
+//Binary columnar file format for batch pricing
+
+#include "ColumnarFormat.hpp"
+#include "BatchFile.hpp"
+#include "BatchPricing.hpp"
+#include "MappedFile.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+namespace ColumnarFormat {
+
+	namespace {
+
+		bool ends_with(const std::string& s, const char* suffix)
+		{
+			std::size_t n = strlen(suffix);
+			return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+		}
+
+		void append_shortest(std::string& buf, double v)		//shortest text that reads back to the same double
+		{
+			char tmp[64];
+			std::to_chars_result res = std::to_chars(tmp, tmp + sizeof(tmp), v);
+			buf.append(tmp, res.ptr - tmp);
+		}
+
+		bool text_to_columnar(const std::string& in_path, const std::string& out_path, std::ostream& err)
+		{
+			MappedFile in(in_path);
+			if (!in.is_open())
+			{
+				err << "Error opening file: " << in_path << '\n';
+				return false;
+			}
+
+			std::vector<double> cols[input_columns];
+			double params[5];
+			std::size_t line = 1;
+			std::size_t errors = 0;
+
+			const char* end = in.data() + in.size();
+			for (const char* p = in.data(); p < end; line++)
+			{
+				const char* eol = (const char*)memchr(p, '\n', end - p);
+				if (!eol)
+					eol = end;
+
+				if (const char* why = ParseQuoteLine(p, eol, params))
+				{
+					err << "line " << line << ": " << why << '\n';
+					errors++;
+				}
+				else
+				{
+					for (std::uint32_t c = 0; c < input_columns; c++)
+						cols[c].push_back(params[c]);
+				}
+
+				p = eol + 1;
+			}
+
+			std::ofstream out(out_path, std::ios::binary);
+			if (!out)
+			{
+				err << "Error opening file: " << out_path << '\n';
+				return false;
+			}
+
+			Header h = MakeHeader(false, cols[0].size());
+			out.write((const char*)&h, sizeof(h));
+			for (std::uint32_t c = 0; c < input_columns; c++)
+				out.write((const char*)cols[c].data(), cols[c].size() * sizeof(double));
+
+			return errors == 0 && (bool)out;
+		}
+
+		bool columnar_to_text(const std::string& in_path, const std::string& out_path, std::ostream& err)
+		{
+			MappedFile in(in_path);
+			if (!in.is_open())
+			{
+				err << "Error opening file: " << in_path << '\n';
+				return false;
+			}
+
+			bool result = in.size() >= sizeof(Header) && memcmp(in.data(), result_magic, 8) == 0;
+			if (const char* why = Validate(in.data(), in.size(), result))
+			{
+				err << in_path << ": " << why << '\n';
+				return false;
+			}
+
+			std::ofstream out(out_path, std::ios::binary);
+			if (!out)
+			{
+				err << "Error opening file: " << out_path << '\n';
+				return false;
+			}
+
+			Header h;
+			memcpy(&h, in.data(), sizeof(h));
+
+			std::vector<const double*> cols;
+			for (std::uint32_t c = 0; c < h.columns; c++)
+				cols.push_back(ColumnPtr(in.data(), c));
+
+			static const char* greek_names[] = { ", Delta call = ", ", Delta put = ", ", Gamma = ", ", Vega = ",
+												 ", Theta call = ", ", Theta put = ", ", Rho call = ", ", Rho put = " };
+			std::string buf;
+
+			for (std::uint64_t i = 0; i < h.rows; i++)
+			{
+				if (!result)
+				{
+					for (std::uint32_t c = 0; c < h.columns; c++)
+					{
+						if (c)
+							buf += ' ';
+						append_shortest(buf, cols[c][i]);
+					}
+					buf += '\n';
+				}
+				else if (h.columns == result_columns)
+					AppendResultLine(buf, i + 1, cols[0][i], cols[1][i]);
+				else
+				{
+					AppendResultLine(buf, i + 1, cols[0][i], cols[1][i]);
+					buf.pop_back();								//continue the line with the greeks
+					for (std::uint32_t c = 2; c < h.columns; c++)
+					{
+						buf += greek_names[c - 2];
+						AppendFixed(buf, cols[c][i]);
+					}
+					buf += '\n';
+				}
+
+				if (buf.size() > (1 << 20))						//write in large blocks
+				{
+					out.write(buf.data(), buf.size());
+					buf.clear();
+				}
+			}
+			out.write(buf.data(), buf.size());
+
+			return (bool)out;
+		}
+
+	}
+
+	Header MakeHeader(bool result, std::uint64_t rows, bool greeks)
+	{
+		Header h;
+		memset(&h, 0, sizeof(h));
+		memcpy(h.magic, result ? result_magic : input_magic, 8);
+		h.version = version;
+		h.columns = result ? (greeks ? greek_columns : result_columns) : input_columns;
+		h.rows = rows;
+		h.flags = (result && greeks) ? flag_greeks : 0;
+		return h;
+	}
+
+	const char* Validate(const char* data, std::size_t size, bool result)
+	{
+		if (size < sizeof(Header))
+			return "file is too short for a columnar header";
+
+		Header h;
+		memcpy(&h, data, sizeof(h));
+
+		if (memcmp(h.magic, result ? result_magic : input_magic, 8) != 0)
+			return result ? "not a columnar results file" : "not a columnar contracts file";
+		if (h.version != version)
+			return "unsupported columnar format version";
+
+		std::uint32_t expected = input_columns;
+		if (result)
+			expected = (h.flags & flag_greeks) ? greek_columns : result_columns;
+		if (h.columns != expected)
+			return "unexpected number of columns";
+
+		if ((size - sizeof(Header)) / sizeof(double) / h.columns < h.rows)
+			return "file is shorter than its header says";
+
+		return nullptr;
+	}
+
+	const double* ColumnPtr(const char* data, std::uint32_t c)
+	{
+		Header h;
+		memcpy(&h, data, sizeof(h));
+		return (const double*)(data + sizeof(Header)) + (std::size_t)c * h.rows;
+	}
+
+	bool PriceFile(const std::string& in_path, const std::string& out_path, bool greeks, unsigned threads,
+				   std::ostream& err)
+	{
+		MappedFile in(in_path);
+		if (!in.is_open())
+		{
+			err << "Error opening file: " << in_path << '\n';
+			return false;
+		}
+
+		if (const char* why = Validate(in.data(), in.size(), false))
+		{
+			err << in_path << ": " << why << '\n';
+			return false;
+		}
+
+		Header in_h;
+		memcpy(&in_h, in.data(), sizeof(in_h));
+		std::size_t n = (std::size_t)in_h.rows;
+
+		Header out_h = MakeHeader(true, n, greeks);
+		MappedFile out;
+		if (!out.create(out_path, sizeof(Header) + (std::size_t)out_h.columns * n * sizeof(double)))
+		{
+			err << "Error opening file: " << out_path << '\n';
+			return false;
+		}
+		memcpy(out.writable_data(), &out_h, sizeof(out_h));
+
+		const double* T = ColumnPtr(in.data(), T_col);
+		const double* K = ColumnPtr(in.data(), K_col);
+		const double* vol = ColumnPtr(in.data(), vol_col);
+		const double* r = ColumnPtr(in.data(), r_col);
+		const double* S = ColumnPtr(in.data(), S_col);
+		double* res = (double*)(out.writable_data() + sizeof(Header));
+
+		auto price_range = [&](std::size_t from, std::size_t to)	//price rows [from, to) straight into the mapped output
+		{
+			std::size_t m = to - from;
+			if (greeks)
+			{
+				BatchPricing::GreekColumns g;
+				double** cols[] = { &g.call, &g.put, &g.delta_call, &g.delta_put, &g.gamma, &g.vega,
+									&g.theta_call, &g.theta_put, &g.rho_call, &g.rho_put };
+				for (std::uint32_t c = 0; c < greek_columns; c++)
+					*cols[c] = res + (std::size_t)c * n + from;
+				BatchPricing::Greeks(S + from, K + from, T + from, r + from, vol + from, g, m);
+			}
+			else
+				BatchPricing::CallPut(S + from, K + from, T + from, r + from, vol + from,
+									  res + from, res + n + from, m);
+		};
+
+		if (threads == 0)
+			threads = std::thread::hardware_concurrency();
+		if (threads <= 1 || n < 2 * BatchPricing::block)
+			price_range(0, n);
+		else
+		{
+			std::size_t step = (n + threads - 1) / threads;
+			step = (step + BatchPricing::block - 1) / BatchPricing::block * BatchPricing::block;
+
+			std::vector<std::thread> pool;
+			for (std::size_t from = 0; from < n; from += step)
+				pool.emplace_back(price_range, from, std::min(n, from + step));
+			for (std::thread& t : pool)
+				t.join();
+		}
+
+		return true;
+	}
+
+	bool Convert(const std::string& in_path, const std::string& out_path, std::ostream& err)
+	{
+		if (ends_with(in_path, ".txt"))
+			return text_to_columnar(in_path, out_path, err);
+		else
+			return columnar_to_text(in_path, out_path, err);
+	}
+
+}
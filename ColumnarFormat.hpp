@@ -0,0 +1,69 @@
+//Binary columnar file format for batch pricing
+//
+//A file is a 64-byte header followed by 'columns' contiguous arrays of 'rows' doubles each.
+//All values are little-endian IEEE 754 and every column starts on an 8-byte boundary, so a
+//mapped file can be used in place as SoA input for BatchPricing.
+//
+//	offset	size	field
+//	0		8		magic: "OPTCOLIN" (contracts) or "OPTCOLRS" (results)
+//	8		4		version (uint32, currently 1)
+//	12		4		columns (uint32)
+//	16		8		rows (uint64)
+//	24		8		flags (uint64, results: bit 0 - greek columns present)
+//	32		32		reserved, zero
+//
+//Contracts files have 5 columns in the text input order: T, K, vol, r, S.
+//Results files have call, put and, with greeks, delta_call, delta_put, gamma, vega,
+//theta_call, theta_put, rho_call, rho_put.
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+#ifndef Columnar_Format_HPP
+#define Columnar_Format_HPP
+
+namespace ColumnarFormat {
+
+	static const char input_magic[8] = { 'O', 'P', 'T', 'C', 'O', 'L', 'I', 'N' };
+	static const char result_magic[8] = { 'O', 'P', 'T', 'C', 'O', 'L', 'R', 'S' };
+	static const std::uint32_t version = 1;
+	static const std::uint32_t input_columns = 5;
+	static const std::uint32_t result_columns = 2;
+	static const std::uint32_t greek_columns = 10;
+	static const std::uint64_t flag_greeks = 1;
+
+	struct Header
+	{
+		char magic[8];
+		std::uint32_t version;
+		std::uint32_t columns;
+		std::uint64_t rows;
+		std::uint64_t flags;
+		char reserved[32];
+	};
+
+	static_assert(sizeof(Header) == 64, "columnar header must be 64 bytes");
+
+	enum Column { T_col, K_col, vol_col, r_col, S_col };	//column order of contracts files
+
+	Header MakeHeader(bool result, std::uint64_t rows, bool greeks = false);
+
+	//Check a mapped buffer, returns nullptr if it is a valid file of the wanted kind or the reason otherwise
+	const char* Validate(const char* data, std::size_t size, bool result);
+
+	//Pointer to column c of a valid file
+	const double* ColumnPtr(const char* data, std::uint32_t c);
+
+	//Price a contracts file into a results file, returns false (with a message in err) on failure
+	bool PriceFile(const std::string& in_path, const std::string& out_path, bool greeks, unsigned threads,
+				   std::ostream& err);
+
+	//Converters between the text formats and the binary ones:
+	//text contracts -> binary contracts, binary contracts -> text contracts, binary results -> text results
+	bool Convert(const std::string& in_path, const std::string& out_path, std::ostream& err);
+
+}
+
+#endif
@@ -0,0 +1,103 @@
+//Forward-mode automatic differentiation: dual numbers x + x' e with e^2 = 0
+//
+//Evaluating a pricing formula on Dual<double> with the input of interest seeded as Dual(x, 1)
+//gives the value and the exact first derivative in one pass. Nesting, Dual<Dual<double>> seeded as
+//Dual(Dual(x, 1), Dual(1, 0)), gives the second derivative in .der.der (e.g. gamma).
+//Overloads of the math functions used by the option formulas and of OptionProbability::N/n are here.
+
+#include "OptionProbability.hpp"
+#include <cmath>
+#include <type_traits>
+
+#ifndef Dual_HPP
+#define Dual_HPP
+
+template<typename T>
+struct Dual
+{
+	T val;										//value
+	T der;										//derivative along the seeded direction
+
+	Dual(const T& v = T(), const T& d = T()) : val(v), der(d) {}
+
+	template<typename U, typename = std::enable_if_t<std::is_arithmetic<U>::value>>
+	Dual(U v) : val(T(v)), der(T(0)) {}			//constants (also into nested duals)
+};
+
+template<typename T>
+inline const T& value_of(const T& x) { return x; }
+
+template<typename T>
+inline double value_of(const Dual<T>& x) { return value_of(x.val); }	//innermost value of a (nested) dual
+
+//Arithmetic
+template<typename T> inline Dual<T> operator-(const Dual<T>& a) { return Dual<T>(-a.val, -a.der); }
+
+template<typename T> inline Dual<T> operator+(const Dual<T>& a, const Dual<T>& b) { return Dual<T>(a.val + b.val, a.der + b.der); }
+template<typename T> inline Dual<T> operator-(const Dual<T>& a, const Dual<T>& b) { return Dual<T>(a.val - b.val, a.der - b.der); }
+template<typename T> inline Dual<T> operator*(const Dual<T>& a, const Dual<T>& b) { return Dual<T>(a.val * b.val, a.der * b.val + a.val * b.der); }
+template<typename T> inline Dual<T> operator/(const Dual<T>& a, const Dual<T>& b)
+{
+	T inv = T(1) / b.val;
+	return Dual<T>(a.val * inv, (a.der - a.val * inv * b.der) * inv);
+}
+
+template<typename T> inline Dual<T> operator+(const Dual<T>& a, double b) { return Dual<T>(a.val + b, a.der); }
+template<typename T> inline Dual<T> operator-(const Dual<T>& a, double b) { return Dual<T>(a.val - b, a.der); }
+template<typename T> inline Dual<T> operator*(const Dual<T>& a, double b) { return Dual<T>(a.val * b, a.der * b); }
+template<typename T> inline Dual<T> operator/(const Dual<T>& a, double b) { return Dual<T>(a.val / b, a.der / b); }
+
+template<typename T> inline Dual<T> operator+(double a, const Dual<T>& b) { return b + a; }
+template<typename T> inline Dual<T> operator-(double a, const Dual<T>& b) { return Dual<T>(a - b.val, -b.der); }
+template<typename T> inline Dual<T> operator*(double a, const Dual<T>& b) { return b * a; }
+template<typename T> inline Dual<T> operator/(double a, const Dual<T>& b) { return Dual<T>(a) / b; }
+
+//Elementary functions (found through ADL from templated formulas)
+template<typename T> inline Dual<T> exp(const Dual<T>& a)
+{
+	using std::exp;
+	T e = exp(a.val);
+	return Dual<T>(e, e * a.der);
+}
+
+template<typename T> inline Dual<T> log(const Dual<T>& a)
+{
+	using std::log;
+	return Dual<T>(log(a.val), a.der / a.val);
+}
+
+template<typename T> inline Dual<T> sqrt(const Dual<T>& a)
+{
+	using std::sqrt;
+	T s = sqrt(a.val);
+	return Dual<T>(s, a.der / (s * 2.0));
+}
+
+template<typename T> inline Dual<T> pow(const Dual<T>& a, double p)
+{
+	using std::pow;
+	return Dual<T>(pow(a.val, p), pow(a.val, p - 1) * p * a.der);
+}
+
+template<typename T> inline Dual<T> pow(const Dual<T>& a, const Dual<T>& p)	//a^p = exp(p log a), a > 0
+{
+	return exp(p * log(a));
+}
+
+//Standard normal CDF/PDF on duals: N' = n, n' = -x n
+namespace OptionProbability {
+
+	template<typename T> inline Dual<T> n(const Dual<T>& x)
+	{
+		T nx = n(x.val);
+		return Dual<T>(nx, -(x.val * nx) * x.der);
+	}
+
+	template<typename T> inline Dual<T> N(const Dual<T>& x)
+	{
+		return Dual<T>(N(x.val), n(x.val) * x.der);
+	}
+
+}
+
+#endif
@@ -1,7 +1,11 @@
 //A plain european option class that calculates option prices, greeks and checks for put-call parity
 
 #include "EuropeanOption.hpp"
+#include "InputValidation.hpp"
 #include "OptionProbability.hpp"
+#include "ImpliedVolatility.hpp"
+#include "Stats.hpp"
+#include <cassert>
 
 //Constructors
 
@@ -34,8 +38,8 @@ void EuropeanOption::S(double newS)
 {
 	if (newS < 0)
 	{
-		std::cout << "Underlying price can't be negative, setting to 1.\n";
-		S_val = 1;
+		Stats::Add(Stats::ClampS);
+		S_val = InputValidation::default_S;
 	} else S_val = newS;
 }
 
@@ -43,8 +47,8 @@ void EuropeanOption::K(double newK)
 {
 	if (newK < 0)
 	{
-		std::cout << "Strike price can't be negative, setting to 0.\n";
-		K_val = 0;
+		Stats::Add(Stats::ClampK);
+		K_val = InputValidation::default_K;
 	} else K_val = newK;
 }
 
@@ -52,8 +56,8 @@ void EuropeanOption::T(double newT)
 {
 	if (newT < 0)
 	{
-		std::cout << "Time to maturity can't be negative, setting to 1.\n";
-		T_val = 1;
+		Stats::Add(Stats::ClampT);
+		T_val = InputValidation::default_T;
 	} else T_val = newT;
 }
 
@@ -61,8 +65,8 @@ void EuropeanOption::r(double newr)
 {
 	if (newr < 0)
 	{
-		std::cout << "B-S model doesn't work with negative interest rate, setting to 5%.\n";
-		r_val = 0.05;
+		Stats::Add(Stats::Clampr);
+		r_val = InputValidation::default_r;
 	} else r_val = newr;
 }
 
@@ -70,18 +74,26 @@ void EuropeanOption::vol(double newvol)
 {
 	if (newvol < 0)
 	{
-		std::cout << "Volatility can't be negative, setting to 30%.\n";
-		vol_val = 0.3;
+		Stats::Add(Stats::Clampvol);
+		vol_val = InputValidation::default_vol;
 	} else vol_val = newvol;
 }
 
 void EuropeanOption::SetValues(const std::vector<double>& params)	//get values from a vector (need to be ordered according to data members)
 {
-	S_val = params[0];
-	K_val = params[1];
-	T_val = params[2];
-	r_val = params[3];
-	vol_val = params[4];
+	SetValues(params.data(), params.size());
+}
+
+void EuropeanOption::SetValues(const double* params, std::size_t count)		//same from an array through the setters, count has to be at least 5
+{
+	assert(count >= 5);
+	(void)count;											//not read otherwise, silences -Wunused-parameter with NDEBUG
+
+	S(params[0]);
+	K(params[1]);
+	T(params[2]);
+	r(params[3]);
+	vol(params[4]);
 }
 
 void EuropeanOption::Print()								//prints option info
@@ -172,79 +184,33 @@ double EuropeanOption::Gamma() const						//get gamma value of an option
 	return OptionProbability::n(d1()) / (S_val * vol_val * sqrt(T_val));
 }
 
-//Approximate sensitivities using divided differences approach (with tol 10^-6)
-double EuropeanOption::approximated_DeltaCall()
+//Fused evaluation
+BlackScholesResult EuropeanOption::Evaluate() const		//prices and greeks sharing d1, d2, N(d1), N(d2), n(d1) and exp(-r*T)
 {
-	double h = 1;											//set initial step to 1
-	double tol = 0.000001;
-	double val_old;
-	double val_new;
-
-	double p1;
-	double p2;
-
-	S_val += h;												//get option prices for S +- h
-	p1 = Call();
-	S_val -= h * 2;
-	p2 = Call();
-	S_val += h;
-	val_old = (p1 - p2) / (2 * h);
-
-	while (true)											//start a loop where we decrease h by power of 10
-	{
-		h = h / 10.0;
-
-		S_val += h;											//get new option prices
-		p1 = Call();
-		S_val -= h * 2;
-		p2 = Call();
-		S_val += h;
-		val_new = (p1 - p2) / (2 * h);
-
-		if (abs(val_new - val_old) > tol)					//keep iterating while change of the resulting value from reduced step is higher than tol
-			val_old = val_new;
-		else
-			break;
-	}
-	return val_new;
+	return black_scholes(S_val, K_val, T_val, r_val, vol_val);
 }
 
-double EuropeanOption::approximated_DeltaPut()				//the same approach for the rest of the approximated greeks
+//Implied volatility
+double EuropeanOption::ImpliedVol(double price) const		//invert B-S in vol (see ImpliedVolatility.hpp for the details)
 {
-	double h = 1;
-	double tol = 0.000001;
-	double val_old;
-	double val_new;
-
-	double p1;
-	double p2;
-
-	S_val += h;
-	p1 = Put();
-	S_val -= h * 2;
-	p2 = Put();
-	S_val += h;
-	val_old = (p1 - p2) / (2 * h);
-
-	while (true)
-	{
-		h = h / 10.0;
-		S_val += h;
-		p1 = Put();
-		S_val -= h * 2;
-		p2 = Put();
-		S_val += h;
-		val_new = (p1 - p2) / (2 * h);
-
-		if (abs(val_new - val_old) > tol)
-			val_old = val_new;
-		else
-			break;
-	}
-	return val_new;
+	return ImpliedVolatility::Solve(price, S_val, K_val, T_val, r_val, type()).vol;
 }
 
-double EuropeanOption::approximated_Delta()
+//Sensitivities by automatic differentiation: S is seeded as a dual number and the price formula
+//is evaluated once on it, a nested dual gives the second derivative
+double EuropeanOption::approximated_DeltaCall() const
+{
+	Dual<double> S(S_val, 1);
+	return CallFormula<Dual<double>>(S, K_val, T_val, r_val, vol_val).der;
+}
+
+double EuropeanOption::approximated_DeltaPut() const
+{
+	Dual<double> S(S_val, 1);
+	return PutFormula<Dual<double>>(S, K_val, T_val, r_val, vol_val).der;
+}
+
+double EuropeanOption::approximated_Delta() const
 {
 	if (type() == 'C')
 		return approximated_DeltaCall();
@@ -252,39 +218,9 @@ double EuropeanOption::approximated_Delta()
 		return approximated_DeltaPut();
 }
 
-double EuropeanOption::approximated_Gamma()
+double EuropeanOption::approximated_Gamma() const
 {
-	double h = 1;
-	double tol = 0.000001;
-	double val_old;
-	double val_new;
-
-	double p;
-	double p1;
-	double p2;
-
-	p = Call();
-	S_val += h;
-	p1 = Call();
-	S_val -= h * 2;
-	p2 = Call();
-	S_val += h;
-	val_old = (p1 - 2 * p + p2) / (h * h);
-
-	while (true)
-	{
-		h = h / 10.0;
-		S_val += h;
-		p1 = Call();
-		S_val -= h * 2;
-		p2 = Call();
-		S_val += h;
-		val_new = (p1 - 2 * p + p2) / (h * h);
-
-		if (abs(val_new - val_old) > tol)
-			val_old = val_new;
-		else
-			break;
-	}
-	return val_new;
+	typedef Dual<Dual<double>> Dual2;
+	Dual2 S(Dual<double>(S_val, 1), Dual<double>(1, 0));
+	return CallFormula<Dual2>(S, K_val, T_val, r_val, vol_val).der.der;
 }
\ No newline at end of file
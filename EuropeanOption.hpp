@@ -1,6 +1,8 @@
 //A plain european option class that calculates option prices, greeks and checks for put-call parity
 
 #include "Option.hpp"
+#include "BlackScholes.hpp"
+#include "Dual.hpp"
 #include <iostream>
 
 #ifndef European_Option_HPP
@@ -37,6 +39,7 @@ public:
 	void r(double newr);
 	void vol(double newvol);
 	void SetValues(const std::vector<double>& params);//set values from a vector of parameters
+	void SetValues(const double* params, std::size_t count);//same from a plain array (used by matrix_eval)
 	void Print();								//prints values of all data members
 
 	//Operator overloading
@@ -56,11 +59,42 @@ public:
 	double Delta() const;						//get delta value given the internal type
 	double Gamma() const;						//get gamma value of an option
 
-	//Approximate sensitivities using divided differences approach (with tol 10^-6)
-	double approximated_DeltaCall();
-	double approximated_DeltaPut();
-	double approximated_Delta();
-	double approximated_Gamma();
+	//Fused evaluation
+	BlackScholesResult Evaluate() const;		//call/put prices and all greeks in one pass
+
+	//Implied volatility
+	double ImpliedVol(double price) const;		//vol that reproduces price for the current type (NaN if there is none)
+
+	//Sensitivities by forward-mode automatic differentiation of the price formulas (exact, S is not modified,
+	//names are kept from the former divided differences implementation)
+	double approximated_DeltaCall() const;
+	double approximated_DeltaPut() const;
+	double approximated_Delta() const;
+	double approximated_Gamma() const;
+
+	//B-S formulas templated on the number type (double, or Dual for automatic differentiation)
+	template<typename D>
+	static D CallFormula(const D& S, const D& K, const D& T, const D& r, const D& vol);
+	template<typename D>
+	static D PutFormula(const D& S, const D& K, const D& T, const D& r, const D& vol);
 };
 
+template<typename D>
+D EuropeanOption::CallFormula(const D& S, const D& K, const D& T, const D& r, const D& vol)
+{
+	using std::exp; using std::log; using std::sqrt;
+	D vsT = vol * sqrt(T);
+	D d1 = (log(S / K) + (r + vol * vol / 2) * T) / vsT;
+	return S * OptionProbability::N(d1) - K * exp(-r * T) * OptionProbability::N(d1 - vsT);
+}
+
+template<typename D>
+D EuropeanOption::PutFormula(const D& S, const D& K, const D& T, const D& r, const D& vol)
+{
+	using std::exp; using std::log; using std::sqrt;
+	D vsT = vol * sqrt(T);
+	D d1 = (log(S / K) + (r + vol * vol / 2) * T) / vsT;
+	return K * exp(-r * T) * OptionProbability::N(vsT - d1) - S * OptionProbability::N(-d1);
+}
+
 #endif
\ No newline at end of file
@@ -0,0 +1,183 @@
+//Implied volatility of european options (inverse of the B-S formula in vol), scalar and SoA batch
+
+#include "ImpliedVolatility.hpp"
+#include "OptionProbability.hpp"
+#include <cmath>
+#include <limits>
+
+namespace ImpliedVolatility {
+
+	namespace {
+
+		const double sqrt_2pi = 2.50662827463100050242;
+		const double max_vol = 100;				//10000% - beyond that the quote is treated as unsolvable
+
+		struct OtmTerms							//price of the out-of-the-money side and its vol derivatives
+		{
+			double price;
+			double vega;
+			double vomma;
+		};
+
+		//B-S price of the OTM option (call if S < DK, put otherwise) for a given vol,
+		//x = log(S / DK) and sqrtT don't change between iterations and are passed in
+		OtmTerms otm_terms(double S, double DK, double x, double sqrtT, bool call, double vol)
+		{
+			double vsT = vol * sqrtT;
+			double d1 = x / vsT + vsT / 2;
+			double d2 = d1 - vsT;
+
+			double Nd1, Nm1, Nd2, Nm2;
+			OptionProbability::N_pair(d1, Nd1, Nm1);
+			OptionProbability::N_pair(d2, Nd2, Nm2);
+
+			OtmTerms res;
+			res.price = call ? S * Nd1 - DK * Nd2 : DK * Nm2 - S * Nm1;
+			res.vega = S * OptionProbability::n(d1) * sqrtT;
+			res.vomma = res.vega * d1 * d2 / vol;
+			return res;
+		}
+
+		double initial_guess(double call, double S, double DK, double T)	//Corrado-Miller with a floor
+		{
+			double half = (S - DK) / 2;
+			double a = call - half;
+			double disc = a * a - (S - DK) * (S - DK) / 3.141592653589793;
+			double vsT = sqrt_2pi / (S + DK) * (a + sqrt(disc > 0 ? disc : 0));
+
+			if (!(vsT > 0))									//formula breaks down far from the money, use the
+				vsT = sqrt(2 * fabs(log(S / DK)));			//vol * sqrt(T) where the OTM vega peaks instead
+
+			return vsT / sqrt(T);
+		}
+
+	}
+
+	Result Solve(double price, double S, double K, double T, double r, char type, double tol, int max_iter)
+	{
+		Result res;
+		res.vol = std::numeric_limits<double>::quiet_NaN();
+
+		if (!(S > 0 && K > 0 && T > 0) || !std::isfinite(price) || !std::isfinite(r) || !std::isfinite(S * K * T))
+			return res;
+
+		double DK = K * exp(-r * T);
+		double call = (type == 'C') ? price : price + S - DK;	//put-call parity
+
+		if (call >= S)
+		{
+			res.status = Status::AboveMaximum;
+			return res;
+		}
+
+		double intrinsic = (S > DK) ? S - DK : 0;
+		if (call <= intrinsic)
+		{
+			res.status = Status::BelowIntrinsic;
+			return res;
+		}
+
+		bool otm_call = S < DK;									//solve on the OTM side: time value only
+		double target = otm_call ? call : call - S + DK;
+
+		double x = log(S / DK);
+		double sqrtT = sqrt(T);
+		double lo = 0;											//bracket of the solution, narrowed every iteration
+		double hi = max_vol;
+
+		double vol = initial_guess(call, S, DK, T);
+		if (!(vol > lo && vol < hi))
+			vol = (lo + hi) / 2;
+
+		res.status = Status::NoConvergence;
+
+		double log_target = log(target);
+
+		for (res.iterations = 1; res.iterations <= max_iter; res.iterations++)
+		{
+			OtmTerms t = otm_terms(S, DK, x, sqrtT, otm_call, vol);
+			double f = log(t.price) - log_target;					//solve in log price: deep OTM prices span hundreds
+																	//of orders of magnitude, their logs are nearly linear in vol
+			if (f == 0)
+			{
+				res.status = Status::Converged;
+				break;
+			}
+
+			if (f > 0)												//price is increasing in vol
+				hi = vol;
+			else
+				lo = vol;
+
+			double next = lo - 1;									//forces bisection unless the Halley step is usable
+			if (t.price > 0 && t.vega > 0)
+			{
+				double f1 = t.vega / t.price;						//first and second derivatives of log price in vol
+				double f2 = t.vomma / t.price - f1 * f1;
+				double newton = f / f1;
+				double correction = 0.5 * newton * f2 / f1;
+				double step = (fabs(correction) < 0.5) ?			//Halley step, plain Newton if the
+					newton / (1 - correction) : newton;				//correction is too large to trust
+				if (fabs(step) < tol)
+				{
+					vol -= step;
+					res.status = Status::Converged;
+					break;
+				}
+
+				next = vol - step;
+			}
+
+			if (!(next > lo && next < hi))							//outside the bracket - bisect instead
+				next = (lo + hi) / 2;
+
+			if (hi - lo < tol)
+			{
+				vol = next;
+				res.status = Status::Converged;
+				break;
+			}
+
+			vol = next;
+		}
+
+		if (res.status == Status::NoConvergence)
+			res.iterations = max_iter;
+		else if (vol >= max_vol * (1 - 1e-9))						//ran into the upper end of the bracket
+		{
+			res.status = Status::AboveMaximum;
+			vol = std::numeric_limits<double>::quiet_NaN();
+		}
+
+		res.vol = vol;
+		return res;
+	}
+
+	void Solve(const double* price, const double* S, const double* K, const double* T, const double* r,
+			   const char* type, double* vol, int* iterations, Status* status, std::size_t n,
+			   double tol, int max_iter)
+	{
+		for (std::size_t i = 0; i < n; i++)						//per-quote iteration counts differ, so this stays a plain loop
+		{
+			Result res = Solve(price[i], S[i], K[i], T[i], r[i], type[i], tol, max_iter);
+			vol[i] = res.vol;
+			if (iterations)
+				iterations[i] = res.iterations;
+			if (status)
+				status[i] = res.status;
+		}
+	}
+
+	const char* StatusText(Status status)
+	{
+		switch (status)
+		{
+		case Status::Converged: return "converged";
+		case Status::BelowIntrinsic: return "price below intrinsic value";
+		case Status::AboveMaximum: return "price above the no-arbitrage maximum";
+		case Status::NoConvergence: return "no convergence";
+		default: return "invalid input";
+		}
+	}
+
+}
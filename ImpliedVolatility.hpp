@@ -0,0 +1,48 @@
+//Implied volatility of european options (inverse of the B-S formula in vol), scalar and SoA batch
+//
+//Puts are mapped to calls through put-call parity and the out-of-the-money side is solved, which
+//keeps the function well conditioned for deep ITM quotes. The equation is solved for the log of the
+//OTM price, which stays close to linear in vol even far from the money. The starting point is the Corrado-Miller
+//approximation, refined by Halley steps (vega and vomma come from the same d1/d2) inside a
+//bracket that falls back to bisection, so every quote inside the no-arbitrage bounds converges.
+
+#include <cstddef>
+
+#ifndef Implied_Volatility_HPP
+#define Implied_Volatility_HPP
+
+namespace ImpliedVolatility {
+
+	enum class Status
+	{
+		Converged,								//vol holds the solution
+		BelowIntrinsic,							//price below max(S - K*exp(-rT), 0) (call) - no solution
+		AboveMaximum,							//price not below S (call) or K*exp(-rT) (put) - no solution
+		NoConvergence,							//iteration limit reached, vol holds the last estimate
+		InvalidInput							//non-positive S, K or T, or non-finite input
+	};
+
+	struct Result
+	{
+		double vol = 0;							//implied volatility (NaN when there is no solution)
+		int iterations = 0;						//number of Halley/bisection steps taken
+		Status status = Status::InvalidInput;
+	};
+
+	static const double default_tol = 1e-12;	//stop when the vol step is below this
+	static const int default_max_iter = 100;
+
+	//type is 'C' or 'P' (same convention as Option::type())
+	Result Solve(double price, double S, double K, double T, double r, char type,
+				 double tol = default_tol, int max_iter = default_max_iter);
+
+	//SoA batch: vol[i] and (when not null) iterations[i], status[i] for every quote
+	void Solve(const double* price, const double* S, const double* K, const double* T, const double* r,
+			   const char* type, double* vol, int* iterations, Status* status, std::size_t n,
+			   double tol = default_tol, int max_iter = default_max_iter);
+
+	const char* StatusText(Status status);		//short description for messages
+
+}
+
+#endif
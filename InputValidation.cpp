@@ -0,0 +1,189 @@
+//Validation of contract parameters as a separate batch pass in front of the pricers
+
+#include "InputValidation.hpp"
+#include "Stats.hpp"
+#include <cmath>
+
+namespace InputValidation {
+
+	namespace {
+
+		inline Status check(double v, Status bit) { return (v >= 0 && v < HUGE_VAL) ? 0 : bit; }	//NaN fails both
+
+		inline void fix(double& v, Status status, Status bit, double replacement)
+		{
+			if (status & bit)
+				v = replacement;
+		}
+
+		void count(Report& report, Status status, std::size_t i)
+		{
+			report.invalid++;
+			if (report.first_invalid == (std::size_t)-1)
+				report.first_invalid = i;
+			for (int f = 0; f < fields; f++)
+				if (status & (1 << f))
+					report.by_field[f]++;
+		}
+
+		void finish(Report& report, Policy policy)
+		{
+			if (policy == Policy::Clamp)
+			{
+				report.clamped = report.invalid;
+				Stats::Add(Stats::ClampS, report.by_field[0]);
+				Stats::Add(Stats::ClampK, report.by_field[1]);
+				Stats::Add(Stats::ClampT, report.by_field[2]);
+				Stats::Add(Stats::Clampr, report.by_field[3]);
+				Stats::Add(Stats::Clampvol, report.by_field[4]);
+				Stats::Add(Stats::Clampb, report.by_field[5]);
+			}
+			else if (policy == Policy::Reject)
+			{
+				report.rejected = report.invalid;
+				Stats::Add(Stats::Rejected, report.invalid);
+			}
+			else
+				report.aborted = report.invalid > 0;
+		}
+
+	}
+
+	void Report::Add(const Report& o)
+	{
+		if (first_invalid == (std::size_t)-1 && o.first_invalid != (std::size_t)-1)
+			first_invalid = rows + o.first_invalid;
+		rows += o.rows;
+		invalid += o.invalid;
+		clamped += o.clamped;
+		rejected += o.rejected;
+		for (int f = 0; f < fields; f++)
+			by_field[f] += o.by_field[f];
+		aborted = aborted || o.aborted;
+	}
+
+	Report European(double* S, double* K, double* T, double* r, double* vol, Status* status, std::size_t n, Policy policy)
+	{
+		Report report;
+
+		for (std::size_t i = 0; i < n; i++)
+		{
+			Status st = check(S[i], BadS) | check(K[i], BadK) | check(T[i], BadT) | check(r[i], Badr) | check(vol[i], Badvol);
+			status[i] = st;
+			report.rows++;
+			if (!st)
+				continue;
+
+			count(report, st, i);
+			if (policy == Policy::Clamp)
+			{
+				fix(S[i], st, BadS, default_S);
+				fix(K[i], st, BadK, default_K);
+				fix(T[i], st, BadT, default_T);
+				fix(r[i], st, Badr, default_r);
+				fix(vol[i], st, Badvol, default_vol);
+			}
+			else if (policy == Policy::Abort)
+				break;
+		}
+
+		finish(report, policy);
+		return report;
+	}
+
+	Report Perpetual(double* S, double* K, double* r, double* b, double* vol, Status* status, std::size_t n, Policy policy)
+	{
+		Report report;
+
+		for (std::size_t i = 0; i < n; i++)
+		{
+			Status st = check(S[i], BadS) | check(K[i], BadK) | check(r[i], Badr) | check(b[i], Badb) | check(vol[i], Badvol);
+			status[i] = st;
+			report.rows++;
+			if (!st)
+				continue;
+
+			count(report, st, i);
+			if (policy == Policy::Clamp)
+			{
+				fix(S[i], st, BadS, default_perpetual_S);
+				fix(K[i], st, BadK, default_K);
+				fix(r[i], st, Badr, default_r);
+				fix(b[i], st, Badb, default_b);
+				fix(vol[i], st, Badvol, default_vol);
+			}
+			else if (policy == Policy::Abort)
+				break;
+		}
+
+		finish(report, policy);
+		return report;
+	}
+
+	std::string Describe(Status status)
+	{
+		static const char* names[fields] = { "S", "K", "T", "r", "vol", "b" };
+		std::string text;
+
+		for (int f = 0; f < fields; f++)
+			if (status & (1 << f))
+			{
+				if (!text.empty())
+					text += ", ";
+				text += names[f];
+			}
+
+		return text;
+	}
+
+	std::string Summary(const Report& report, Policy policy)
+	{
+		if (!report.invalid)
+			return std::string();
+
+		std::string text = std::to_string(report.invalid) + " of " + std::to_string(report.rows) +
+						   " rows had negative or non-finite inputs (";
+		bool first = true;
+		for (int f = 0; f < fields; f++)
+			if (report.by_field[f])
+			{
+				text += first ? "" : ", ";
+				text += Describe((Status)(1 << f)) + " " + std::to_string(report.by_field[f]);
+				first = false;
+			}
+		text += "), ";
+
+		switch (policy)
+		{
+		case Policy::Clamp: text += "replaced by the defaults"; break;
+		case Policy::Reject: text += "rejected"; break;
+		default: text += "aborted at the first one";
+		}
+
+		return text;
+	}
+
+	const char* Name(Policy policy)
+	{
+		switch (policy)
+		{
+		case Policy::Clamp: return "clamp";
+		case Policy::Reject: return "reject";
+		default: return "abort";
+		}
+	}
+
+	bool ParsePolicy(const std::string& text, Policy& policy)
+	{
+		if (text == "clamp")
+			policy = Policy::Clamp;
+		else if (text == "reject")
+			policy = Policy::Reject;
+		else if (text == "abort")
+			policy = Policy::Abort;
+		else
+			return false;
+		return true;
+	}
+
+}
@@ -0,0 +1,66 @@
+//Validation of contract parameters as a separate batch pass in front of the pricers
+//
+//Every row gets a status bitmask with one bit per invalid field (negative, NaN or infinite), the pass
+//itself does no I/O, it only counts. What happens to a bad row depends on the policy: Clamp replaces the
+//bad fields with the same defaults the option setters use, Reject leaves the row out of pricing, Abort
+//stops at the first bad row. Messages for the user are built afterwards from the masks (Describe()).
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#ifndef Input_Validation_HPP
+#define Input_Validation_HPP
+
+namespace InputValidation {
+
+	typedef std::uint8_t Status;				//0 - every field is valid
+
+	static const Status BadS = 1;
+	static const Status BadK = 2;
+	static const Status BadT = 4;
+	static const Status Badr = 8;
+	static const Status Badvol = 16;
+	static const Status Badb = 32;				//cost of carry, perpetual options only
+	static const int fields = 6;
+
+	enum class Policy { Clamp, Reject, Abort };
+
+	//Replacement values, shared with the setters of the option classes
+	static const double default_S = 1;
+	static const double default_K = 0;
+	static const double default_T = 1;
+	static const double default_r = 0.05;
+	static const double default_vol = 0.3;
+	static const double default_perpetual_S = 0;
+	static const double default_b = 0.05;
+
+	struct Report
+	{
+		std::size_t rows = 0;					//rows checked
+		std::size_t invalid = 0;				//rows with at least one bad field
+		std::size_t clamped = 0;				//of them fixed by the Clamp policy
+		std::size_t rejected = 0;				//left out by the Reject policy
+		std::size_t by_field[fields] = {};		//bad values per field, in the order of the Status bits
+		bool aborted = false;					//Abort policy met a bad row
+		std::size_t first_invalid = (std::size_t)-1;	//index of the first bad row
+
+		void Add(const Report& o);				//append the report of the next batch of rows
+	};
+
+	//Check n european rows in place, status[i] receives the mask of row i. Clamp overwrites the bad fields,
+	//Reject and Abort leave the columns untouched (with Abort the rows after the first bad one are not checked).
+	Report European(double* S, double* K, double* T, double* r, double* vol, Status* status, std::size_t n, Policy policy);
+
+	//Same for perpetual american rows
+	Report Perpetual(double* S, double* K, double* r, double* b, double* vol, Status* status, std::size_t n, Policy policy);
+
+	std::string Describe(Status status);		//"S, vol" - names of the bad fields
+	std::string Summary(const Report& report, Policy policy);	//one line for the error stream, empty if nothing was invalid
+
+	const char* Name(Policy policy);
+	bool ParsePolicy(const std::string& text, Policy& policy);	//"clamp", "reject" or "abort"
+
+}
+
+#endif
@@ -0,0 +1,293 @@
+//A lattice option class: CRR binomial or trinomial tree, european or american exercise
+
+#include "LatticeOption.hpp"
+#include "InputValidation.hpp"
+#include "OptionProbability.hpp"
+#include "Stats.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+//Constructors
+
+LatticeOption::LatticeOption()							//default constructor has just initialized data members
+	:Option()
+{
+}
+
+LatticeOption::LatticeOption(const LatticeOption& o)		//copy constructor copies all data mebers
+	:S_val(o.S_val), K_val(o.K_val), T_val(o.T_val),
+	r_val(o.r_val), vol_val(o.vol_val), q_val(o.q_val), settings_val(o.settings_val)
+{
+	if (type() != o.type())
+		toggle();
+}
+
+//Destructor
+LatticeOption::~LatticeOption()
+{
+}
+
+//Selectors (get value of respective data member)
+double LatticeOption::S() const { return S_val; }
+double LatticeOption::K() const { return K_val; }
+double LatticeOption::T() const { return T_val; }
+double LatticeOption::r() const { return r_val; }
+double LatticeOption::vol() const { return vol_val; }
+double LatticeOption::q() const { return q_val; }
+const LatticeSettings& LatticeOption::settings() const { return settings_val; }
+
+//Modifiers (also check for negative input)
+void LatticeOption::S(double newS)
+{
+	if (newS < 0)
+	{
+		Stats::Add(Stats::ClampS);
+		S_val = InputValidation::default_S;
+	} else S_val = newS;
+}
+
+void LatticeOption::K(double newK)
+{
+	if (newK < 0)
+	{
+		Stats::Add(Stats::ClampK);
+		K_val = InputValidation::default_K;
+	} else K_val = newK;
+}
+
+void LatticeOption::T(double newT)
+{
+	if (newT < 0)
+	{
+		Stats::Add(Stats::ClampT);
+		T_val = InputValidation::default_T;
+	} else T_val = newT;
+}
+
+void LatticeOption::r(double newr)
+{
+	if (newr < 0)
+	{
+		Stats::Add(Stats::Clampr);
+		r_val = InputValidation::default_r;
+	} else r_val = newr;
+}
+
+void LatticeOption::vol(double newvol)
+{
+	if (newvol < 0)
+	{
+		Stats::Add(Stats::Clampvol);
+		vol_val = InputValidation::default_vol;
+	} else vol_val = newvol;
+}
+
+void LatticeOption::q(double newq)
+{
+	if (newq < 0)
+	{
+		Stats::Add(Stats::Clampq);
+		q_val = 0;
+	} else q_val = newq;
+}
+
+void LatticeOption::settings(const LatticeSettings& newsettings)
+{
+	settings_val = newsettings;
+}
+
+void LatticeOption::SetValues(const std::vector<double>& params)	//get values from a vector (need to be ordered according to data members)
+{
+	SetValues(params.data(), params.size());
+}
+
+void LatticeOption::SetValues(const double* params, std::size_t count)	//same from an array through the setters, count has to be at least 5
+{
+	assert(count >= 5);
+
+	S(params[0]);
+	K(params[1]);
+	T(params[2]);
+	r(params[3]);
+	vol(params[4]);
+	q((count > 5) ? params[5] : 0);
+}
+
+//Operator overloading
+LatticeOption&
+LatticeOption::operator=(const LatticeOption& src)		//assignment operator checks for self-assignment
+{
+	if (this == &src)
+		return *this;
+	else
+	{
+		S_val = src.S_val;
+		K_val = src.K_val;
+		T_val = src.T_val;
+		r_val = src.r_val;
+		vol_val = src.vol_val;
+		q_val = src.q_val;
+		settings_val = src.settings_val;
+		if (type() != src.type())
+			toggle();
+
+		return *this;
+	}
+}
+
+//Tree engine
+namespace {
+
+	//Black-Scholes value with dividend yield q over the last time step, used to smooth the tree
+	inline double european(double sgn, double S, double K, double t, double r, double q, double vol)
+	{
+		double sd = vol * std::sqrt(t);
+		double d1 = (std::log(S / K) + (r - q + vol * vol / 2) * t) / sd;
+		return sgn * (S * std::exp(-q * t) * OptionProbability::N(sgn * d1) -
+					  K * std::exp(-r * t) * OptionProbability::N(sgn * (d1 - sd)));
+	}
+
+}
+
+double LatticeOption::induction(bool call, std::size_t N, std::vector<double>& ws, bool smooth) const
+{
+	double sgn = call ? 1.0 : -1.0;
+	bool american = settings_val.american;
+	bool tri = settings_val.tree == LatticeType::Trinomial;
+
+	double dt = T_val / N;
+	double b = r_val - q_val;
+	double disc = std::exp(-r_val * dt);
+	double u, pu, pm = 0, pd;								//up move and discounted branch probabilities
+	double c = 1;											//growth of the centre of the tree per step
+
+	//When the drift beats the vol, |b| dt > vol sqrt(dt), the branch probabilities leave [0, 1] and the
+	//induction blows up. The tree is then centred on the forward instead (moves c u^k with c = e^(b dt)),
+	//which keeps them in (0, 1) for any drift.
+	if (tri)												//moves of +-vol*sqrt(2 dt), probabilities matching the drift
+	{
+		double e = std::exp(vol_val * std::sqrt(dt / 2));
+		double g = std::exp(b * dt / 2);
+		if (g > e || g < 1 / e)								//qu or qd outside [0, 1]
+		{
+			c = g * g;
+			g = 1;
+		}
+		double den = e - 1 / e;
+		double qu = (g - 1 / e) / den;
+		double qd = (e - g) / den;
+		u = e * e;
+		pu = disc * qu * qu;
+		pd = disc * qd * qd;
+		pm = disc * (1 - qu * qu - qd * qd);
+	}
+	else													//CRR: d = 1 / u
+	{
+		u = std::exp(vol_val * std::sqrt(dt));
+		double g = std::exp(b * dt);
+		if (g > u || g < 1 / u)								//p outside [0, 1]
+		{
+			c = g;
+			g = 1;
+		}
+		double p = (g - 1 / u) / (u - 1 / u);
+		pu = disc * p;
+		pd = disc * (1 - p);
+	}
+
+	std::size_t width = tri ? 2 * N + 1 : N + 1;			//nodes of the last level
+	if (ws.size() < 2 * width)
+		ws.resize(2 * width);
+	double* v = ws.data();
+	double* s = v + width;
+
+	double ratio = tri ? u : u * u;							//spot ratio of neighbouring nodes
+	double back = u / c;									//node i of level j is node i of level j + 1 times back
+	s[0] = S_val * std::pow(c, (double)N) * std::pow(u, -(double)N);
+	for (std::size_t i = 1; i < width; i++)
+		s[i] = s[i - 1] * ratio;
+	std::size_t top = N;									//first level computed by the backward loop
+	if (smooth)												//BBS: level N - 1 takes Black-Scholes values instead of the
+	{														//kinked payoff, so the error no longer oscillates with the strike
+		top = N - 1;
+		std::size_t m = tri ? 2 * top + 1 : top + 1;
+		for (std::size_t i = 0; i < m; i++)
+		{
+			s[i] *= back;
+			v[i] = european(sgn, s[i], K_val, dt, r_val, q_val, vol_val);
+			if (american)
+				v[i] = std::max(v[i], sgn * (s[i] - K_val));
+		}
+	}
+	else
+		for (std::size_t i = 0; i < width; i++)
+			v[i] = std::max(sgn * (s[i] - K_val), 0.0);
+
+	for (std::size_t j = top; j-- > 0;)						//level j from level j + 1, in place: node i only reads i .. i + 2
+	{
+		std::size_t m = tri ? 2 * j + 1 : j + 1;
+
+		if (tri)
+			for (std::size_t i = 0; i < m; i++)
+				v[i] = pd * v[i] + pm * v[i + 1] + pu * v[i + 2];
+		else
+			for (std::size_t i = 0; i < m; i++)
+				v[i] = pd * v[i] + pu * v[i + 1];
+
+		if (american)										//node spots of level j are the ones of level j + 1 times back
+			for (std::size_t i = 0; i < m; i++)
+			{
+				s[i] *= back;
+				v[i] = std::max(v[i], sgn * (s[i] - K_val));
+			}
+	}
+
+	return v[0];
+}
+
+double LatticeOption::price(bool call, std::vector<double>& ws) const
+{
+	double sgn = call ? 1.0 : -1.0;
+	bool american = settings_val.american;
+
+	if (T_val <= 0 || vol_val <= 0 || S_val <= 0)			//degenerate cases have closed forms
+	{
+		double fwd = sgn * (S_val * std::exp(-q_val * T_val) - K_val * std::exp(-r_val * T_val));
+		double value = std::max(fwd, 0.0);
+		if (american || T_val <= 0)
+			value = std::max(value, sgn * (S_val - K_val));
+		return std::max(value, 0.0);
+	}
+
+	std::size_t N = std::max<std::size_t>(settings_val.steps, 2);
+	if (!settings_val.richardson)
+		return induction(call, N, ws, false);
+
+	return 2 * induction(call, N, ws, true) - induction(call, N / 2, ws, true);	//BBSR
+}
+
+//Option prices
+double LatticeOption::Call() const
+{
+	static thread_local std::vector<double> ws;
+	return price(true, ws);
+}
+
+double LatticeOption::Put() const
+{
+	static thread_local std::vector<double> ws;
+	return price(false, ws);
+}
+
+void LatticeOption::SolveMany(const LatticeOption* options, double* out, std::size_t n, unsigned threads)
+{
+	auto sweep = [&](std::size_t from, std::size_t to)			//one workspace per thread
+	{
+		std::vector<double> ws;
+		for (std::size_t i = from; i < to; i++)
+			out[i] = options[i].price(options[i].type() == 'C', ws);
+	};
+
+	split_rows(n, threads, sweep);
+}
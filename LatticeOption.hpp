@@ -0,0 +1,98 @@
+//A lattice option class: CRR binomial or trinomial tree, european or american exercise
+//
+//Backward induction runs in place in one array of option values (plus one of node spots), so memory
+//is linear in the number of steps. Every level is a flat loop where node i only reads nodes i .. i + 2
+//of the level after it, which the compiler vectorizes; the early exercise check is a max() in the
+//same loop. With LatticeSettings::richardson both trees are smoothed first (BBS: the last time step
+//takes Black-Scholes values instead of the kinked payoff) and the price is extrapolated from N and N / 2
+//steps as 2 P(N) - P(N / 2). Without the smoothing the error oscillates with the position of the strike
+//between nodes and the extrapolation can make off-node strikes worse; with it the error is regular.
+//
+//r = 0.05, vol = 0.3, T = 1. American put S = K = 100, q = 0.02 against a 6000 step smoothed trinomial
+//tree (10.471265), american call S = 100, K = 110, q = 0 against its european price (10.020078):
+//
+//	tree				steps	put error	call error	time per solve
+//	binomial			 200	8.2e-3		5.6e-3		  55 us
+//	binomial			 800	2.0e-3		3.3e-3		 850 us
+//	binomial + rich.	 200	6.7e-4		2.1e-4		  95 us
+//	trinomial			 200	5.6e-3		4.3e-4		 110 us
+//	trinomial + rich.	 400	1.5e-4		4.0e-6		 650 us
+//
+//Low vol, european call S = K = 100, vol = 0.002 (4.877058), 500 steps: the drift r - q beats vol * sqrt(dt),
+//so the CRR branch probabilities leave [0, 1] (the plain tree returned 1.1e9). The tree is then centred on
+//the forward and both trees are within 1e-11 with or without smoothing; the trinomial tree switches
+//over once (r - q) * sqrt(dt / 2) > vol, e.g. vol = 0.001.
+//
+//Parameters are S, K, T, r, vol and an optional continuous dividend yield q, same as AmericanOption,
+//so both engines can be cross-checked on the same contracts.
+
+#include "Option.hpp"
+#include <cstddef>
+#include <iostream>
+#include <vector>
+
+#ifndef Lattice_Option_HPP
+#define Lattice_Option_HPP
+
+enum class LatticeType { Binomial, Trinomial };
+
+struct LatticeSettings
+{
+	LatticeType tree = LatticeType::Binomial;
+	std::size_t steps = 500;					//time steps of the tree
+	bool american = true;						//false - european exercise
+	bool richardson = false;					//smooth the last step, extrapolate from steps and steps / 2
+};
+
+class LatticeOption : public Option
+{
+private:
+	double S_val = 0;							//option pricing parameters
+	double K_val = 0;
+	double T_val = 1;
+	double r_val = 0.05;
+	double vol_val = 0.3;
+	double q_val = 0;							//continuous dividend yield
+	LatticeSettings settings_val;
+
+	double induction(bool call, std::size_t steps, std::vector<double>& ws, bool smooth) const;	//one tree, ws holds values and spots
+	double price(bool call, std::vector<double>& ws) const;
+
+public:
+	//Constructors and destructor
+	LatticeOption();
+	LatticeOption(const LatticeOption& o);
+	virtual ~LatticeOption();
+
+	//Selectors
+	double S() const;
+	double K() const;
+	double T() const;
+	double r() const;
+	double vol() const;
+	double q() const;
+	const LatticeSettings& settings() const;
+
+	//Modifiers
+	void S(double newS);
+	void K(double newK);
+	void T(double newT);
+	void r(double newr);
+	void vol(double newvol);
+	void q(double newq);
+	void settings(const LatticeSettings& newsettings);
+	void SetValues(const std::vector<double>& params);//set values from a vector of parameters (S, K, T, r, vol and optional q)
+	void SetValues(const double* params, std::size_t count);//same from a plain array (used by matrix_eval)
+
+	//Operator overloading
+	LatticeOption& operator=(const LatticeOption& src);
+
+	//Option prices
+	double Call() const;						//get price for call option (thread local workspace)
+	double Put() const;							//get price for put option
+
+	//Price n options according to their types, split between threads (0 - all hardware threads)
+	static void SolveMany(const LatticeOption* options, double* out, std::size_t n, unsigned threads = 1);
+};
+
+#endif
@@ -0,0 +1,200 @@
+//Memory-mapped view of a whole file (mmap on POSIX, file mapping on Windows)
+
+#include "MappedFile.hpp"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+//Constructors and destructor
+MappedFile::MappedFile()
+{
+}
+
+MappedFile::MappedFile(const std::string& path)
+{
+	open(path);
+}
+
+MappedFile::~MappedFile()
+{
+	close();
+}
+
+//Selectors
+bool MappedFile::is_open() const
+{
+#ifdef _WIN32
+	return file_handle != nullptr;
+#else
+	return fd >= 0;
+#endif
+}
+
+const char* MappedFile::data() const { return data_val; }
+char* MappedFile::writable_data() { return data_val; }
+std::size_t MappedFile::size() const { return size_val; }
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::string& path)
+{
+	close();
+
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+							  FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size))
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	file_handle = file;
+	size_val = (std::size_t)size.QuadPart;
+
+	if (size_val == 0)											//empty files can't be mapped, nothing to read anyway
+		return true;
+
+	map_handle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (map_handle)
+		data_val = (char*)MapViewOfFile(map_handle, FILE_MAP_READ, 0, 0, 0);
+
+	if (!data_val)
+	{
+		close();
+		return false;
+	}
+	return true;
+}
+
+bool MappedFile::create(const std::string& path, std::size_t size)
+{
+	close();
+
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+							  FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	file_handle = file;
+	size_val = size;
+
+	if (size_val == 0)
+		return true;
+
+	map_handle = CreateFileMappingA(file, nullptr, PAGE_READWRITE,
+									(DWORD)((unsigned long long)size >> 32), (DWORD)(size & 0xFFFFFFFF), nullptr);
+	if (map_handle)
+		data_val = (char*)MapViewOfFile(map_handle, FILE_MAP_WRITE, 0, 0, 0);
+
+	if (!data_val)
+	{
+		close();
+		return false;
+	}
+	return true;
+}
+
+void MappedFile::close()
+{
+	if (data_val)
+		UnmapViewOfFile(data_val);
+	if (map_handle)
+		CloseHandle(map_handle);
+	if (file_handle)
+		CloseHandle(file_handle);
+
+	data_val = nullptr;
+	map_handle = nullptr;
+	file_handle = nullptr;
+	size_val = 0;
+}
+
+#else
+
+bool MappedFile::open(const std::string& path)
+{
+	close();
+
+	fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat st;
+	if (fstat(fd, &st) != 0)
+	{
+		close();
+		return false;
+	}
+
+	size_val = (std::size_t)st.st_size;
+
+	if (size_val == 0)											//empty files can't be mapped, nothing to read anyway
+		return true;
+
+	void* p = mmap(nullptr, size_val, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (p == MAP_FAILED)
+	{
+		close();
+		return false;
+	}
+
+	madvise(p, size_val, MADV_SEQUENTIAL);						//we scan front to back exactly once
+	data_val = (char*)p;
+	return true;
+}
+
+bool MappedFile::create(const std::string& path, std::size_t size)
+{
+	close();
+
+	fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0)
+		return false;
+
+	size_val = size;
+
+	if (size_val == 0)
+		return true;
+
+	if (ftruncate(fd, (off_t)size_val) != 0)
+	{
+		close();
+		return false;
+	}
+
+	void* p = mmap(nullptr, size_val, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (p == MAP_FAILED)
+	{
+		close();
+		return false;
+	}
+
+	data_val = (char*)p;
+	return true;
+}
+
+void MappedFile::close()
+{
+	if (data_val)
+		munmap(data_val, size_val);
+	if (fd >= 0)
+		::close(fd);
+
+	data_val = nullptr;
+	size_val = 0;
+	fd = -1;
+}
+
+#endif
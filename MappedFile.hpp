@@ -0,0 +1,42 @@
+//Memory-mapped view of a whole file (mmap on POSIX, file mapping on Windows)
+//open() maps an existing file read-only, create() makes a new file of given size mapped read-write
+
+#include <cstddef>
+#include <string>
+
+#ifndef Mapped_File_HPP
+#define Mapped_File_HPP
+
+class MappedFile
+{
+private:
+	char* data_val = nullptr;					//start of the mapped bytes
+	std::size_t size_val = 0;					//file size in bytes
+#ifdef _WIN32
+	void* file_handle = nullptr;
+	void* map_handle = nullptr;
+#else
+	int fd = -1;
+#endif
+
+public:
+	//Constructors and destructor
+	MappedFile();
+	explicit MappedFile(const std::string& path);
+	MappedFile(const MappedFile& o) = delete;
+	virtual ~MappedFile();
+
+	MappedFile& operator=(const MappedFile& src) = delete;
+
+	bool open(const std::string& path);			//map the file, returns false if it can't be opened
+	bool create(const std::string& path, std::size_t size);	//create/truncate the file to size and map it writable
+	void close();
+
+	//Selectors
+	bool is_open() const;
+	const char* data() const;
+	char* writable_data();						//only valid after create()
+	std::size_t size() const;
+};
+
+#endif
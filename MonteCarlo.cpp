@@ -0,0 +1,380 @@
+//Monte Carlo engine for path-dependent options (arithmetic Asians and discretely monitored barriers)
+
+#include "MonteCarlo.hpp"
+#include "EuropeanOption.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+namespace MonteCarlo {
+
+	namespace {
+
+		//Joe-Kuo (new-joe-kuo-6.21201) primitive polynomials and initial direction numbers for dimensions 2..21,
+		//dimension 1 is the van der Corput sequence
+		struct SobolInit
+		{
+			unsigned s;							//degree
+			unsigned a;							//inner coefficients
+			unsigned m[7];
+		};
+
+		const SobolInit sobol_init[sobol_dimensions - 1] = {
+			{ 1, 0, { 1 } },
+			{ 2, 1, { 1, 3 } },
+			{ 3, 1, { 1, 3, 1 } },
+			{ 3, 2, { 1, 1, 1 } },
+			{ 4, 1, { 1, 1, 3, 3 } },
+			{ 4, 4, { 1, 3, 5, 13 } },
+			{ 5, 2, { 1, 1, 5, 5, 17 } },
+			{ 5, 4, { 1, 1, 5, 5, 5 } },
+			{ 5, 7, { 1, 1, 7, 11, 19 } },
+			{ 5, 11, { 1, 1, 5, 1, 1 } },
+			{ 5, 13, { 1, 1, 1, 3, 11 } },
+			{ 5, 14, { 1, 3, 5, 5, 31 } },
+			{ 6, 1, { 1, 3, 3, 9, 7, 49 } },
+			{ 6, 13, { 1, 1, 1, 15, 21, 21 } },
+			{ 6, 16, { 1, 3, 1, 13, 27, 49 } },
+			{ 6, 19, { 1, 1, 1, 15, 7, 5 } },
+			{ 6, 22, { 1, 3, 1, 15, 13, 25 } },
+			{ 6, 25, { 1, 1, 5, 5, 19, 61 } },
+			{ 7, 1, { 1, 3, 7, 11, 23, 15, 103 } },
+			{ 7, 4, { 1, 3, 7, 13, 13, 15, 69 } }
+		};
+
+		struct Sobol							//32-bit direction numbers of the built-in dimensions
+		{
+			std::uint32_t V[sobol_dimensions][32];
+
+			Sobol()
+			{
+				for (unsigned i = 0; i < 32; i++)
+					V[0][i] = 1u << (31 - i);
+
+				for (std::size_t d = 1; d < sobol_dimensions; d++)
+				{
+					const SobolInit& p = sobol_init[d - 1];
+					std::uint32_t* v = V[d];
+
+					for (unsigned i = 0; i < p.s; i++)
+						v[i] = p.m[i] << (31 - i);
+					for (unsigned i = p.s; i < 32; i++)
+					{
+						v[i] = v[i - p.s] ^ (v[i - p.s] >> p.s);
+						for (unsigned k = 1; k < p.s; k++)
+							if ((p.a >> (p.s - 1 - k)) & 1)
+								v[i] ^= v[i - k];
+					}
+				}
+			}
+
+			std::uint32_t point(std::size_t d, std::uint64_t n) const	//n-th point (gray code order) of dimension d
+			{
+				std::uint64_t g = n ^ (n >> 1);
+				std::uint32_t x = 0;
+				for (unsigned i = 0; g && i < 32; i++, g >>= 1)
+					if (g & 1)
+						x ^= V[d][i];
+				return x;
+			}
+		};
+
+		inline double to_unit(std::uint32_t hi, std::uint32_t lo)	//53 random bits to (0, 1)
+		{
+			std::uint64_t bits = ((std::uint64_t)hi << 21) ^ (lo >> 11);
+			return (bits + 0.5) * (1.0 / 9007199254740992.0);
+		}
+
+		struct Sums								//what a block contributes, added in block order
+		{
+			double n = 0;
+			double y = 0, yy = 0;				//discounted payoff
+			double x = 0, xx = 0, xy = 0;		//discounted european payoff (control)
+		};
+
+		struct Workspace						//state of one block of paths
+		{
+			std::vector<double> z, z_next, log_s[2], sum[2];
+			std::vector<char> hit[2];
+
+			void resize(std::size_t n)
+			{
+				for (std::vector<double>* v : { &z, &z_next, &log_s[0], &log_s[1], &sum[0], &sum[1] })
+					v->resize(n);
+				hit[0].resize(n);
+				hit[1].resize(n);
+			}
+		};
+
+		//samples [first, first + count), a sample is one path or an antithetic pair
+		void run_block(const Contract& c, const Settings& s, const Sobol& sobol, std::uint64_t first, std::size_t count,
+					   Workspace& ws, Sums& out)
+		{
+			ws.resize(count);
+
+			std::size_t lanes = s.antithetic ? 2 : 1;
+			std::size_t steps = std::max<std::size_t>(c.steps, 1);
+			double dt = c.T / steps;
+			double drift = (c.r - c.q - c.vol * c.vol / 2) * dt;
+			double diffusion = c.vol * std::sqrt(dt);
+			double log_s0 = std::log(c.S);
+			bool up = c.payoff == Payoff::UpAndOut || c.payoff == Payoff::UpAndIn;
+			bool barrier = c.payoff != Payoff::AsianArithmetic;
+			double log_barrier = barrier ? std::log(c.barrier) : 0;
+
+			std::uint32_t key[2] = { (std::uint32_t)s.seed, (std::uint32_t)(s.seed >> 32) };
+
+			for (std::size_t l = 0; l < lanes; l++)
+			{
+				std::fill(ws.log_s[l].begin(), ws.log_s[l].begin() + count, log_s0);
+				std::fill(ws.sum[l].begin(), ws.sum[l].begin() + count, 0.0);
+				std::fill(ws.hit[l].begin(), ws.hit[l].begin() + count, 0);
+			}
+
+			for (std::size_t k = 0; k < steps; k++)
+			{
+				double* z = ws.z.data();
+
+				if (s.sobol && k < sobol_dimensions)				//gray code walk from the first point of the block
+				{
+					std::uint64_t n = first + 1;					//point 0 is skipped
+					std::uint32_t x = sobol.point(k, n);
+					for (std::size_t i = 0; i < count; i++, n++)
+					{
+						z[i] = InverseNormal((x + 0.5) * (1.0 / 4294967296.0));
+						std::uint64_t m = n + 1;
+						unsigned bit = 0;
+						while (!(m & 1))
+						{
+							m >>= 1;
+							bit++;
+						}
+						x ^= sobol.V[k][bit];
+					}
+				}
+				else if (k % 2 == 0)								//one Philox call gives the normals of dates k and k + 1
+				{
+					for (std::size_t i = 0; i < count; i++)
+					{
+						std::uint64_t path = first + i;
+						std::uint32_t ctr[4] = { (std::uint32_t)path, (std::uint32_t)(path >> 32), (std::uint32_t)(k / 2), 0 };
+						std::uint32_t r[4];
+						Philox4x32(ctr, key, r);
+						z[i] = InverseNormal(to_unit(r[0], r[1]));
+						ws.z_next[i] = InverseNormal(to_unit(r[2], r[3]));
+					}
+				}
+				else
+					z = ws.z_next.data();
+
+				for (std::size_t l = 0; l < lanes; l++)
+				{
+					double sd = l ? -diffusion : diffusion;
+					double* ls = ws.log_s[l].data();
+					double* sum = ws.sum[l].data();
+					char* hit = ws.hit[l].data();
+
+					for (std::size_t i = 0; i < count; i++)
+					{
+						ls[i] += drift + sd * z[i];
+						if (barrier)
+							hit[i] |= up ? (ls[i] >= log_barrier) : (ls[i] <= log_barrier);
+						else
+							sum[i] += std::exp(ls[i]);
+					}
+				}
+
+				if (s.sobol && k < sobol_dimensions && k % 2 == 0 && k + 1 >= sobol_dimensions)
+				{
+					//the next date is the first Philox one and Philox dates come in pairs - fill z_next for it
+					for (std::size_t i = 0; i < count; i++)
+					{
+						std::uint64_t path = first + i;
+						std::uint32_t ctr[4] = { (std::uint32_t)path, (std::uint32_t)(path >> 32), (std::uint32_t)((k + 1) / 2), 0 };
+						std::uint32_t r[4];
+						Philox4x32(ctr, key, r);
+						ws.z_next[i] = InverseNormal(to_unit(r[2], r[3]));
+					}
+				}
+			}
+
+			double sgn = (c.type == 'C') ? 1.0 : -1.0;
+			double disc = std::exp(-c.r * c.T);
+			bool knock_in = c.payoff == Payoff::UpAndIn || c.payoff == Payoff::DownAndIn;
+
+			for (std::size_t i = 0; i < count; i++)
+			{
+				double y = 0, x = 0;
+				for (std::size_t l = 0; l < lanes; l++)
+				{
+					double ST = std::exp(ws.log_s[l][i]);
+					double plain = std::max(sgn * (ST - c.K), 0.0);
+					double v;
+					if (!barrier)
+						v = std::max(sgn * (ws.sum[l][i] / steps - c.K), 0.0);
+					else
+						v = ((ws.hit[l][i] != 0) == knock_in) ? plain : 0.0;
+
+					y += v;
+					x += plain;
+				}
+				y *= disc / lanes;
+				x *= disc / lanes;
+
+				out.y += y;
+				out.yy += y * y;
+				out.x += x;
+				out.xx += x * x;
+				out.xy += x * y;
+			}
+			out.n += count;
+		}
+
+	}
+
+	void Philox4x32(const std::uint32_t counter[4], const std::uint32_t key[2], std::uint32_t out[4])
+	{
+		std::uint32_t c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+		std::uint32_t k0 = key[0], k1 = key[1];
+
+		for (int round = 0; round < 10; round++)
+		{
+			std::uint64_t p0 = (std::uint64_t)0xD2511F53u * c0;
+			std::uint64_t p1 = (std::uint64_t)0xCD9E8D57u * c2;
+			std::uint32_t n0 = (std::uint32_t)(p1 >> 32) ^ c1 ^ k0;
+			std::uint32_t n2 = (std::uint32_t)(p0 >> 32) ^ c3 ^ k1;
+			c1 = (std::uint32_t)p1;
+			c3 = (std::uint32_t)p0;
+			c0 = n0;
+			c2 = n2;
+			k0 += 0x9E3779B9u;
+			k1 += 0xBB67AE85u;
+		}
+
+		out[0] = c0;
+		out[1] = c1;
+		out[2] = c2;
+		out[3] = c3;
+	}
+
+	double InverseNormal(double u)
+	{
+		static const double a[] = { -3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02,
+									1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00 };
+		static const double b[] = { -5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02,
+									6.680131188771972e+01, -1.328068155288572e+01 };
+		static const double c[] = { -7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+									-2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00 };
+		static const double d[] = { 7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00,
+									3.754408661907416e+00 };
+		const double low = 0.02425;
+
+		if (u < low)											//lower tail
+		{
+			double q = std::sqrt(-2 * std::log(u));
+			return (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+				((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1);
+		}
+		if (u > 1 - low)										//upper tail
+		{
+			double q = std::sqrt(-2 * std::log(1 - u));
+			return -(((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+				((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1);
+		}
+
+		double q = u - 0.5;
+		double r = q * q;
+		return (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q /
+			(((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1);
+	}
+
+	Result Price(const Contract& contract, const Settings& settings)
+	{
+		auto t0 = std::chrono::steady_clock::now();
+
+		static const Sobol sobol;
+		std::size_t lanes = settings.antithetic ? 2 : 1;
+		std::size_t samples = std::max<std::size_t>(settings.paths / lanes, 2);
+		std::size_t block = std::max<std::size_t>(settings.block, 1);
+		std::size_t blocks = (samples + block - 1) / block;
+		std::vector<Sums> sums(blocks);
+
+		unsigned threads = settings.threads;
+		if (threads == 0)
+			threads = std::thread::hardware_concurrency();
+		if (threads == 0)
+			threads = 1;
+		if (threads > blocks)
+			threads = (unsigned)blocks;
+
+		std::atomic<std::size_t> next(0);
+		auto worker = [&]()										//blocks are handed out dynamically, their sums stay in place
+		{
+			Workspace ws;
+			for (std::size_t b; (b = next.fetch_add(1)) < blocks;)
+			{
+				std::size_t first = b * block;
+				run_block(contract, settings, sobol, first, std::min(block, samples - first), ws, sums[b]);
+			}
+		};
+
+		if (threads <= 1)
+			worker();
+		else
+		{
+			std::vector<std::thread> pool;
+			for (unsigned t = 0; t < threads; t++)
+				pool.emplace_back(worker);
+			for (std::thread& t : pool)
+				t.join();
+		}
+
+		Sums total;
+		for (const Sums& s : sums)								//fixed order - same result for any thread count
+		{
+			total.n += s.n;
+			total.y += s.y;
+			total.yy += s.yy;
+			total.x += s.x;
+			total.xx += s.xx;
+			total.xy += s.xy;
+		}
+
+		double n = total.n;
+		double mean_y = total.y / n;
+		double var_y = std::max(total.yy / n - mean_y * mean_y, 0.0) * n / (n - 1);
+
+		Result res;
+		res.price = mean_y;
+		res.std_error = std::sqrt(var_y / n);
+
+		if (settings.control_variate)
+		{
+			EuropeanOption european;							//the control's exact mean
+			european.SetValues({ contract.S * std::exp(-contract.q * contract.T), contract.K, contract.T,
+								 contract.r, contract.vol });
+			double exact = (contract.type == 'C') ? european.Call() : european.Put();
+
+			double mean_x = total.x / n;
+			double var_x = total.xx / n - mean_x * mean_x;
+			double cov = total.xy / n - mean_x * mean_y;
+
+			if (var_x > 0)
+			{
+				res.beta = cov / var_x;
+				res.price = mean_y - res.beta * (mean_x - exact);
+				double var_res = std::max(var_y - cov * cov / var_x * n / (n - 1), 0.0);
+				res.std_error = std::sqrt(var_res / n);
+			}
+		}
+
+		res.paths = samples * lanes;
+		res.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+		res.paths_per_second = res.seconds > 0 ? res.paths / res.seconds : 0;
+		return res;
+	}
+
+}
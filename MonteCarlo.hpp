@@ -0,0 +1,80 @@
+//Monte Carlo engine for path-dependent options (arithmetic Asians and discretely monitored barriers)
+//
+//The underlying follows GBM with dividend yield q and is sampled exactly on Contract::steps equally
+//spaced monitoring dates. Normals come from a counter-based Philox4x32-10 generator keyed on the seed
+//and indexed by (path, date), or optionally from a Sobol sequence (Joe-Kuo direction numbers for the
+//first sobol_dimensions dates, Philox beyond them), so any path can be generated on any thread.
+//
+//Paths are simulated in blocks of Settings::block paths, date by date, with only the running state of
+//the block in memory (log spot, running sum, barrier flag). Every block produces fixed sums and the
+//sums are added in block order, so results are bit-identical for any number of threads.
+//
+//Variance reduction: antithetic pairs (z, -z) and a control variate - the discounted plain european
+//payoff on the same path, whose expectation is EuropeanOption::Call()/Put() (dividends through S*exp(-qT)),
+//with the regression coefficient estimated from the same samples.
+//
+//std_error is the usual iid estimate, with Sobol points it is only an upper bound of the actual error.
+
+#include <cstddef>
+#include <cstdint>
+
+#ifndef Monte_Carlo_HPP
+#define Monte_Carlo_HPP
+
+namespace MonteCarlo {
+
+	static const std::size_t sobol_dimensions = 21;	//dates covered by the built-in direction numbers
+
+	enum class Payoff
+	{
+		AsianArithmetic,						//max(A - K, 0) / max(K - A, 0), A - average over the monitoring dates
+		UpAndOut,								//plain payoff unless S >= barrier on some date
+		UpAndIn,
+		DownAndOut,								//plain payoff unless S <= barrier on some date
+		DownAndIn
+	};
+
+	struct Contract
+	{
+		double S = 100;
+		double K = 100;
+		double T = 1;
+		double r = 0.05;
+		double vol = 0.3;
+		double q = 0;							//continuous dividend yield
+		char type = 'C';						//'C' or 'P'
+		Payoff payoff = Payoff::AsianArithmetic;
+		double barrier = 0;
+		std::size_t steps = 12;					//monitoring dates, the last one is T
+	};
+
+	struct Settings
+	{
+		std::size_t paths = 100000;				//antithetic pairs count as two paths
+		std::uint64_t seed = 1;
+		bool antithetic = true;
+		bool control_variate = true;
+		bool sobol = false;
+		unsigned threads = 1;					//0 - all hardware threads, doesn't change the result
+		std::size_t block = 1024;				//paths simulated together, the state of a block stays in L1/L2
+	};
+
+	struct Result
+	{
+		double price = 0;
+		double std_error = 0;
+		std::size_t paths = 0;
+		double beta = 0;						//control variate coefficient (0 without it)
+		double seconds = 0;
+		double paths_per_second = 0;
+	};
+
+	Result Price(const Contract& contract, const Settings& settings);
+
+	//Building blocks
+	void Philox4x32(const std::uint32_t counter[4], const std::uint32_t key[2], std::uint32_t out[4]);	//10 rounds
+	double InverseNormal(double u);				//Acklam's approximation, relative error < 1.2e-9
+
+}
+
+#endif
@@ -3,6 +3,8 @@
 //according to derived option type
 
 #include "Option.hpp"
+#include <algorithm>
+#include <thread>
 
 #ifndef Option_CPP
 #define Option_CPP
@@ -18,34 +20,87 @@ mesh_array(double start, double step, double length)					//make a vector where e
 	return res;
 }
 
+template<typename F>
+void
+split_rows(std::size_t rows, unsigned threads, F sweep)
+{
+	if (threads == 0)
+		threads = std::thread::hardware_concurrency();
+	if (threads <= 1 || rows < 2 * (std::size_t)threads)
+	{
+		sweep(0, rows);
+		return;
+	}
+
+	std::vector<std::thread> pool;
+	std::size_t step = (rows + threads - 1) / threads;
+
+	for (std::size_t from = 0; from < rows; from += step)				//contiguous row ranges, one per thread
+		pool.emplace_back(sweep, from, std::min(rows, from + step));
+
+	for (std::thread& t : pool)
+		t.join();
+}
+
 template<typename T>
 std::vector<double>
 matrix_calc(const std::vector<std::vector<double>>& source,				//template function that allows to utilize class methods while working with matrices
 			char type, double (T::* method)() const)
 {
-	T temp;																//make a temporary Option object to utilize
+	return matrix_eval<T>(source, type, { method })[0];				//a single method sweep of the batch evaluator
+}
+
+template<typename T>
+void
+matrix_eval(const double* const* columns, std::size_t params,			//batch evaluator over parameter columns, several methods per sweep
+			std::size_t rows, char type,
+			const std::vector<OptionMethod<T>>& methods,
+			double* const* out, unsigned threads)
+{
+	auto sweep = [&](std::size_t from, std::size_t to)					//evaluate rows [from, to) with one Option object
+	{
+		T temp;															//make a temporary Option object to utilize
 																		//its option pricing functionality
+		if (temp.type() != type)										//check if the type is correct
+			temp.toggle();
 
-	if (temp.type() != type)											//check if the type is correct
-		temp.toggle();
+		std::vector<double> buff(params);								//one row of parameters, reused for every row
 
-	std::vector<double> res;											//make a vector to store obtained results
+		for (std::size_t i = from; i < to; i++)
+		{
+			for (std::size_t p = 0; p < params; p++)					//gather the row from the strided columns
+				buff[p] = columns[p][i];
 
-	for (int i = 0; i < source[0].size(); i++)							//iterating through the matrix
-	{
-		std::vector<double> buff;										//create a buffer for each row of parameters
+			temp.T::SetValues(buff.data(), params);						//qualified call - no virtual dispatch
 
-		for (int ii = 0; ii < source.size(); ii++)						//fill it
-		{
-			buff.push_back(source[ii][i]);
+			for (std::size_t m = 0; m < methods.size(); m++)			//apply every method (price, greeks etc) to the same row
+				out[m][i] = (temp.*methods[m])();
 		}
+	};
 
-		temp.SetValues(buff);											//set our Option values
+	split_rows(rows, threads, sweep);
+}
 
-		res.push_back((temp.*method)());								//and apply the method (calculate price, greeks etc)
-	}
+template<typename T>
+std::vector<std::vector<double>>
+matrix_eval(const std::vector<std::vector<double>>& source,
+			char type, const std::vector<OptionMethod<T>>& methods,
+			unsigned threads)
+{
+	std::size_t rows = source.empty() ? 0 : source[0].size();
+
+	std::vector<const double*> columns;
+	for (const std::vector<double>& col : source)
+		columns.push_back(col.data());
 
-	return res;															//return the vector
+	std::vector<std::vector<double>> res(methods.size(), std::vector<double>(rows));	//result columns sized up front
+	std::vector<double*> out;
+	for (std::vector<double>& col : res)
+		out.push_back(col.data());
+
+	matrix_eval<T>(columns.data(), columns.size(), rows, type, methods, out.data(), threads);
+
+	return res;
 }
 
 #endif
\ No newline at end of file
@@ -2,6 +2,7 @@
 //Price() method calculates corresponding type and Put-Call methods have to be impemented
 //according to derived option type
 
+#include <cstddef>
 #include <vector>
 
 #ifndef Option_HPP
@@ -36,6 +37,13 @@ public:
 	}
 
 	virtual void SetValues(const std::vector<double>& params) = 0;	//pvf to work with matrices of option parameters
+
+	virtual void SetValues(const double* params, std::size_t count)	//same from a plain array, derived classes override it
+	{																//to avoid building a vector for every row
+		SetValues(std::vector<double>(params, params + count));
+	}
+
+	virtual ~Option() {}
 };
 
 //Global functions
@@ -48,6 +56,27 @@ std::vector<double>
 matrix_calc(const std::vector<std::vector<double>>& source,		//template function that allows to utilize class methods while working with matrices
 			char type, double (T::* method)() const);
 
+template<typename F>
+void
+split_rows(std::size_t rows, unsigned threads, F sweep);		//call sweep(from, to) on contiguous row ranges, one per thread
+																//(0 - all hardware threads, small batches stay on the caller)
+
+template<typename T>
+using OptionMethod = double (T::*)() const;						//pointer to a pricing/greek method, e.g. &EuropeanOption::Gamma
+
+template<typename T>
+void
+matrix_eval(const double* const* columns, std::size_t params,	//batch evaluator: columns[p][row] holds parameter p of every row,
+			std::size_t rows, char type,						//out[m][row] receives methods[m] of every row, rows are split
+			const std::vector<OptionMethod<T>>& methods,		//between threads (0 - all hardware threads)
+			double* const* out, unsigned threads = 1);
+
+template<typename T>
+std::vector<std::vector<double>>
+matrix_eval(const std::vector<std::vector<double>>& source,		//same for a matrix stored as a vector of parameter columns,
+			char type, const std::vector<OptionMethod<T>>& methods,	//returns one result column per method
+			unsigned threads = 1);
+
 #ifndef Option_CPP												//for linking
 #include "Option.cpp"
 #endif
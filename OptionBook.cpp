@@ -0,0 +1,136 @@
+//Book of european contracts grouped by underlying, repriced incrementally on spot ticks
+
+#include "OptionBook.hpp"
+#include "BatchPricing.hpp"
+#include "OptionProbability.hpp"
+#include <algorithm>
+#include <cmath>
+
+//Constructors and destructor
+OptionBook::OptionBook()
+{
+}
+
+OptionBook::~OptionBook()
+{
+}
+
+void OptionBook::set_invariants(Underlying& u, std::size_t i, double T, double K, double r, double vol)
+{
+	double sqrtT = std::sqrt(T);
+	double vsT = vol * sqrtT;
+
+	u.sqrtT[i] = sqrtT;
+	u.vsT[i] = vsT;
+	u.inv_vsT[i] = 1 / vsT;
+	u.drift[i] = (-std::log(K) + (r + vol * vol / 2) * T) / vsT;
+	u.DK[i] = K * std::exp(-r * T);
+}
+
+void OptionBook::reprice(Underlying& u, std::size_t first, std::size_t last)
+{
+	const std::size_t block = BatchPricing::block;
+	double d1[block];
+	double d2[block];
+	double nd1[block];
+	double Nm1[block];
+	double Nm2[block];
+
+	double S = u.spot;
+	double logS = std::log(S);					//the only transcendental per tick that isn't per contract
+	double invS = 1 / S;
+
+	for (std::size_t start = first; start < last; start += block)
+	{
+		std::size_t m = std::min(block, last - start);
+		const double* inv_vsT = u.inv_vsT.data() + start;
+		const double* drift = u.drift.data() + start;
+		const double* vsT = u.vsT.data() + start;
+
+		for (std::size_t i = 0; i < m; i++)
+		{
+			d1[i] = logS * inv_vsT[i] + drift[i];
+			d2[i] = d1[i] - vsT[i];
+		}
+
+		OptionProbability::n(d1, nd1, m);
+		OptionProbability::N_pair(d1, d1, Nm1, m);	//d1/d2 become N(d1)/N(d2)
+		OptionProbability::N_pair(d2, d2, Nm2, m);
+
+		for (std::size_t i = 0; i < m; i++)		//same formulas as black_scholes()
+		{
+			std::size_t j = start + i;
+			double DK = u.DK[j];
+
+			u.call[j] = S * d1[i] - DK * d2[i];
+			u.put[j] = DK * Nm2[i] - S * Nm1[i];
+			u.delta_call[j] = d1[i];
+			u.delta_put[j] = -Nm1[i];
+			u.gamma[j] = nd1[i] * inv_vsT[i] * invS;
+			u.vega[j] = S * nd1[i] * u.sqrtT[j];
+		}
+	}
+}
+
+//Modifiers
+std::size_t OptionBook::AddUnderlying(double spot)
+{
+	underlyings.emplace_back();
+	underlyings.back().spot = spot;
+	return underlyings.size() - 1;
+}
+
+std::size_t OptionBook::AddContract(std::size_t underlying, double T, double K, double r, double vol)
+{
+	Underlying& u = underlyings[underlying];
+	std::size_t i = u.call.size();
+
+	for (std::vector<double>* col : { &u.vsT, &u.inv_vsT, &u.drift, &u.DK, &u.sqrtT,
+									  &u.call, &u.put, &u.delta_call, &u.delta_put, &u.gamma, &u.vega })
+		col->push_back(0);
+
+	set_invariants(u, i, T, K, r, vol);
+	reprice(u, i, i + 1);
+	return i;
+}
+
+void OptionBook::UpdateContract(std::size_t underlying, std::size_t index, double T, double K, double r, double vol)
+{
+	Underlying& u = underlyings[underlying];
+	set_invariants(u, index, T, K, r, vol);
+	reprice(u, index, index + 1);
+}
+
+void OptionBook::Tick(std::size_t underlying, double spot)
+{
+	Underlying& u = underlyings[underlying];
+	u.spot = spot;
+	reprice(u, 0, u.call.size());
+}
+
+void OptionBook::Reserve(std::size_t underlying, std::size_t contracts)
+{
+	Underlying& u = underlyings[underlying];
+	for (std::vector<double>* col : { &u.vsT, &u.inv_vsT, &u.drift, &u.DK, &u.sqrtT,
+									  &u.call, &u.put, &u.delta_call, &u.delta_put, &u.gamma, &u.vega })
+		col->reserve(contracts);
+}
+
+//Selectors
+std::size_t OptionBook::Underlyings() const { return underlyings.size(); }
+std::size_t OptionBook::Contracts(std::size_t underlying) const { return underlyings[underlying].call.size(); }
+double OptionBook::Spot(std::size_t underlying) const { return underlyings[underlying].spot; }
+
+double OptionBook::Call(std::size_t underlying, std::size_t index) const { return underlyings[underlying].call[index]; }
+double OptionBook::Put(std::size_t underlying, std::size_t index) const { return underlyings[underlying].put[index]; }
+double OptionBook::DeltaCall(std::size_t underlying, std::size_t index) const { return underlyings[underlying].delta_call[index]; }
+double OptionBook::DeltaPut(std::size_t underlying, std::size_t index) const { return underlyings[underlying].delta_put[index]; }
+double OptionBook::Gamma(std::size_t underlying, std::size_t index) const { return underlyings[underlying].gamma[index]; }
+double OptionBook::Vega(std::size_t underlying, std::size_t index) const { return underlyings[underlying].vega[index]; }
+
+const double* OptionBook::Calls(std::size_t underlying) const { return underlyings[underlying].call.data(); }
+const double* OptionBook::Puts(std::size_t underlying) const { return underlyings[underlying].put.data(); }
+const double* OptionBook::DeltaCalls(std::size_t underlying) const { return underlyings[underlying].delta_call.data(); }
+const double* OptionBook::DeltaPuts(std::size_t underlying) const { return underlyings[underlying].delta_put.data(); }
+const double* OptionBook::Gammas(std::size_t underlying) const { return underlyings[underlying].gamma.data(); }
+const double* OptionBook::Vegas(std::size_t underlying) const { return underlyings[underlying].vega.data(); }
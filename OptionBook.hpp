@@ -0,0 +1,80 @@
+//Book of european contracts grouped by underlying, repriced incrementally on spot ticks
+//
+//Everything in B-S that doesn't depend on the spot is computed once per contract when it is added:
+//vol*sqrt(T), the discounted strike K*exp(-r*T) and the drift part of d1, so that
+//
+//	d1 = log(S) / (vol*sqrt(T)) + (-log(K) + (r + vol^2/2) * T) / (vol*sqrt(T))
+//
+//is a single multiply-add per contract once log(S) has been taken for the tick. A tick on one
+//underlying touches only that underlying's contracts, which are kept in contiguous columns.
+//
+//Values are used as given (no clamping like EuropeanOption setters do), T and vol must be positive.
+
+#include <cstddef>
+#include <vector>
+
+#ifndef Option_Book_HPP
+#define Option_Book_HPP
+
+class OptionBook
+{
+private:
+	struct Underlying
+	{
+		double spot = 0;
+
+		//per-contract invariants
+		std::vector<double> vsT;				//vol*sqrt(T)
+		std::vector<double> inv_vsT;			//1 / (vol*sqrt(T))
+		std::vector<double> drift;				//(-log(K) + (r + vol^2/2) * T) / (vol*sqrt(T))
+		std::vector<double> DK;					//K*exp(-r*T)
+		std::vector<double> sqrtT;
+
+		//outputs at the last spot
+		std::vector<double> call;
+		std::vector<double> put;
+		std::vector<double> delta_call;
+		std::vector<double> delta_put;
+		std::vector<double> gamma;
+		std::vector<double> vega;
+	};
+
+	std::vector<Underlying> underlyings;
+
+	static void set_invariants(Underlying& u, std::size_t i, double T, double K, double r, double vol);
+	static void reprice(Underlying& u, std::size_t first, std::size_t last);	//contracts [first, last) at u.spot
+
+public:
+	//Constructors and destructor
+	OptionBook();
+	virtual ~OptionBook();
+
+	//Modifiers
+	std::size_t AddUnderlying(double spot);		//returns the id used by the other functions
+	std::size_t AddContract(std::size_t underlying, double T, double K, double r, double vol);	//returns the index within the underlying, priced at its current spot
+	void UpdateContract(std::size_t underlying, std::size_t index, double T, double K, double r, double vol);
+	void Tick(std::size_t underlying, double spot);	//new spot, reprices only the contracts of this underlying
+	void Reserve(std::size_t underlying, std::size_t contracts);
+
+	//Selectors
+	std::size_t Underlyings() const;
+	std::size_t Contracts(std::size_t underlying) const;
+	double Spot(std::size_t underlying) const;
+
+	double Call(std::size_t underlying, std::size_t index) const;
+	double Put(std::size_t underlying, std::size_t index) const;
+	double DeltaCall(std::size_t underlying, std::size_t index) const;
+	double DeltaPut(std::size_t underlying, std::size_t index) const;
+	double Gamma(std::size_t underlying, std::size_t index) const;
+	double Vega(std::size_t underlying, std::size_t index) const;
+
+	//Whole columns of an underlying, Contracts(underlying) values each, valid until the next AddContract
+	const double* Calls(std::size_t underlying) const;
+	const double* Puts(std::size_t underlying) const;
+	const double* DeltaCalls(std::size_t underlying) const;
+	const double* DeltaPuts(std::size_t underlying) const;
+	const double* Gammas(std::size_t underlying) const;
+	const double* Vegas(std::size_t underlying) const;
+};
+
+#endif
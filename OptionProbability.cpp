@@ -1,6 +1,7 @@
 //This file implements probability related functions to use in option pricing formulae
 
 #include "OptionProbability.hpp"
+#include "Stats.hpp"
 
 namespace OptionProbability {
 
@@ -41,16 +42,22 @@ namespace OptionProbability {
 
     double std_N(double x)                          //integrated part of standard normal pdf
     {
-        return (exp(pow(x, 2) / -2));
+        return exp(x * x / -2);
     }
 
     double n(double x)								//standrad normal PDF
     {
-        return std_N(x) * PI_base;
+#ifdef OPTION_PROBABILITY_TABLE
+        return table_pdf(x);
+#else
+        return exp(x * x / -2) * PI_base;
+#endif
     }
 
     double simpson_cdf(double x)                    //numerical approximation of standard normal CDF using Simpson's rule
     {
+        Stats::Add(Stats::SimpsonCalls);
+
         if (x == 0) return 0.5;
 
         double I_old = 0;
@@ -78,17 +85,61 @@ namespace OptionProbability {
 
             else
             {
+                Stats::Add(Stats::SimpsonRefinements);
+
                 I_old = I_new;
 
                 I_new = (0.5 - rule_simpson(x, 0, n, &std_N) * PI_base);
             }
         }
 
+        Stats::Add(Stats::SimpsonUnconverged);
+
+        return I_new;                               //best estimate if the tolerance was never reached
+    }
+
+    double erfc_cdf(double x)                       //closed form standard normal CDF: N(x) = erfc(-x / sqrt(2)) / 2
+    {
+        return 0.5 * erfc(-x * 0.70710678118654752440);
     }
 
     double N(double x)								//interface for standrad normal CDF calculation
     {
+#if defined(OPTION_PROBABILITY_SIMPSON)
         return simpson_cdf(x);
+#elif defined(OPTION_PROBABILITY_TABLE)
+        return table_cdf(x);
+#else
+        return erfc_cdf(x);
+#endif
+    }
+
+    void N_pair(double x, double& lower, double& upper)    //N(x) and N(-x): the small one is the CDF tail, the other is 1 - tail
+    {
+        double tail = N(-fabs(x));
+        lower = (x < 0) ? tail : 1 - tail;
+        upper = (x < 0) ? 1 - tail : tail;
+    }
+
+    float n(float x)                                //single precision PDF
+    {
+        return std::exp(x * x / -2) * (float)PI_base;
+    }
+
+    float N(float x)                                //single precision CDF
+    {
+#ifdef OPTION_PROBABILITY_SIMPSON
+        return (float)simpson_cdf(x);
+#else
+        return 0.5f * std::erfc(-x * 0.70710678f);
+#endif
+    }
+
+    void N_pair(float x, float& lower, float& upper)
+    {
+        float tail = N(-std::fabs(x));
+        lower = (x < 0) ? tail : 1 - tail;
+        upper = (x < 0) ? 1 - tail : tail;
     }
 
 }
\ No newline at end of file
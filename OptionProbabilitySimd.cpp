@@ -0,0 +1,763 @@
+//Array versions of the normal CDF/PDF with AVX2 / AVX-512 kernels and runtime CPU dispatch
+//
+//The CDF tail N(-|x|) is the Hart/West double precision rational approximation (6/7 degree rational
+//times exp(-x^2/2) below |x| = 7.07, a continued fraction above it, 0 beyond 37), exp is a range
+//reduced degree 12 polynomial and the rounding error of x^2 is corrected with an FMA, so every SIMD
+//kernel evaluates the same formulas in the same order (their last few values go through the same formulas
+//in scalar code). Without a SIMD kernel the double CDF arrays loop over the scalar N()/N_pair(), which are
+//about twice as fast as the Hart/West formulas in scalar code and accurate in the far tail.
+//Kernels are compiled with per-function target attributes, so no special compiler flags are needed.
+
+#include "OptionProbability.hpp"
+#include <atomic>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define OPTION_PROBABILITY_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define OPTION_PROBABILITY_TARGET(t) __attribute__((target(t)))
+#else
+#define OPTION_PROBABILITY_TARGET(t)
+#endif
+
+namespace OptionProbability {
+
+	namespace {
+
+		//Hart/West coefficients of the tail N(-a), a = |x|
+		const double P[7] = { 3.52624965998911e-02, 0.700383064443688, 6.37396220353165, 33.912866078383,
+							  112.079291497871, 221.213596169931, 220.206867912376 };
+		const double Q[8] = { 8.83883476483184e-02, 1.75566716318264, 16.064177579207, 86.7807322029461,
+							  296.564248779674, 637.333633378831, 793.826512519948, 440.413735824752 };
+		const double split = 7.07106781186547;			//rational below, continued fraction above
+		const int fraction_terms = 16;					//West uses 4 (absolute accuracy), 16 keep the tail relative error < 1e-16
+		const double cutoff = 37;						//tail is 0 beyond
+		const double inv_sqrt_2pi = 0.398942280401432677940;
+
+		//exp(v) = 2^k * exp(r), |r| <= ln2 / 2, Taylor polynomial of degree 12 (< 1 ulp truncation error)
+		const double log2e = 1.4426950408889634074;
+		const double ln2_hi = 6.93147180369123816490e-01;
+		const double ln2_lo = 1.90821492927058770002e-10;
+		const double exp_min = -708;					//results below are flushed to 0 by the callers
+		const double E[13] = { 1.0 / 479001600, 1.0 / 39916800, 1.0 / 3628800, 1.0 / 362880, 1.0 / 40320, 1.0 / 5040,
+							   1.0 / 720, 1.0 / 120, 1.0 / 24, 1.0 / 6, 0.5, 1, 1 };
+
+		//Single precision: same formulas, the tail underflows beyond 13, exp needs degree 7 and the
+		//continued fraction 8 terms for float accuracy
+		const float split_f = 7.07106781f;
+		const int fraction_terms_f = 8;
+		const float cutoff_f = 13;
+		const float ln2_hi_f = 0.693359375f;			//8 significant bits, k * ln2_hi_f is exact
+		const float ln2_lo_f = -2.12194440e-4f;
+		const float exp_min_f = -87;
+		const int exp_degree_f = 7;
+
+		inline double exp_scalar(double v)
+		{
+			if (v < exp_min)
+				return 0;
+			double k = std::nearbyint(v * log2e);
+			double r = v - k * ln2_hi;
+			r = r - k * ln2_lo;
+			double p = E[0];
+			for (int i = 1; i < 13; i++)
+				p = p * r + E[i];
+			return std::ldexp(p, (int)k);
+		}
+
+		inline double gauss_scalar(double x)			//exp(-x^2 / 2) with the rounding error of x^2 taken into account
+		{
+			double c = 134217729.0 * x;					//Veltkamp split, exact x^2 = hi + lo without an FMA instruction
+			double xh = c - (c - x);
+			double xl = x - xh;
+			double hi = x * x;
+			double lo = ((xh * xh - hi) + 2 * xh * xl) + xl * xl;
+			double e = exp_scalar(-0.5 * hi);
+			return e - 0.5 * lo * e;
+		}
+
+		inline double tail_scalar(double x)				//N(-|x|)
+		{
+			double a = std::fabs(x);
+			if (a > cutoff)
+				return 0;
+
+			double e = gauss_scalar(a);
+			if (a < split)
+			{
+				double num = P[0], den = Q[0];
+				for (int i = 1; i < 7; i++)
+					num = num * a + P[i];
+				for (int i = 1; i < 8; i++)
+					den = den * a + Q[i];
+				return e * num / den;
+			}
+
+			double b = a + 0.65;
+			for (int k = fraction_terms; k > 0; k--)
+				b = a + k / b;
+			return e / b * inv_sqrt_2pi;
+		}
+
+		inline double pdf_scalar(double x)
+		{
+			return gauss_scalar(x) * PI_base;
+		}
+
+#if defined(OPTION_PROBABILITY_X86) && !defined(OPTION_PROBABILITY_SIMPSON)
+		void N_rest(const double* x, double* out, std::size_t count)	//remainder of the SIMD kernels, same formulas
+		{
+			for (std::size_t i = 0; i < count; i++)
+			{
+				double t = tail_scalar(x[i]);
+				out[i] = (x[i] < 0) ? t : 1 - t;
+			}
+		}
+
+		void N_pair_rest(const double* x, double* lower, double* upper, std::size_t count)
+		{
+			for (std::size_t i = 0; i < count; i++)
+			{
+				double xi = x[i];
+				double t = tail_scalar(xi);
+				lower[i] = (xi < 0) ? t : 1 - t;
+				upper[i] = (xi < 0) ? 1 - t : t;
+			}
+		}
+
+#endif
+
+		void n_scalar(const double* x, double* out, std::size_t count)
+		{
+			for (std::size_t i = 0; i < count; i++)
+				out[i] = pdf_scalar(x[i]);
+		}
+
+		//Single precision scalar kernels
+		inline float exp_scalar(float v)
+		{
+			if (v < exp_min_f)
+				return 0;
+			float k = std::nearbyint(v * (float)log2e);
+			float r = v - k * ln2_hi_f;
+			r = r - k * ln2_lo_f;
+			float p = (float)E[12 - exp_degree_f];
+			for (int i = 13 - exp_degree_f; i < 13; i++)
+				p = p * r + (float)E[i];
+			return std::ldexp(p, (int)k);
+		}
+
+		inline float gauss_scalar(float x)
+		{
+			float c = 4097.0f * x;
+			float xh = c - (c - x);
+			float xl = x - xh;
+			float hi = x * x;
+			float lo = ((xh * xh - hi) + 2 * xh * xl) + xl * xl;
+			float e = exp_scalar(-0.5f * hi);
+			return e - 0.5f * lo * e;
+		}
+
+		inline float tail_scalar(float x)
+		{
+			float a = std::fabs(x);
+			if (a > cutoff_f)
+				return 0;
+
+			float e = gauss_scalar(a);
+			if (a < split_f)
+			{
+				float num = (float)P[0], den = (float)Q[0];
+				for (int i = 1; i < 7; i++)
+					num = num * a + (float)P[i];
+				for (int i = 1; i < 8; i++)
+					den = den * a + (float)Q[i];
+				return e * num / den;
+			}
+
+			float b = a + 0.65f;
+			for (int k = fraction_terms_f; k > 0; k--)
+				b = a + k / b;
+			return e / b * (float)inv_sqrt_2pi;
+		}
+
+		void N_scalar(const float* x, float* out, std::size_t count)
+		{
+			for (std::size_t i = 0; i < count; i++)
+			{
+				float t = tail_scalar(x[i]);
+				out[i] = (x[i] < 0) ? t : 1 - t;
+			}
+		}
+
+		void N_pair_scalar(const float* x, float* lower, float* upper, std::size_t count)
+		{
+			for (std::size_t i = 0; i < count; i++)
+			{
+				float xi = x[i];
+				float t = tail_scalar(xi);
+				lower[i] = (xi < 0) ? t : 1 - t;
+				upper[i] = (xi < 0) ? 1 - t : t;
+			}
+		}
+
+		void n_scalar(const float* x, float* out, std::size_t count)
+		{
+			for (std::size_t i = 0; i < count; i++)
+				out[i] = gauss_scalar(x[i]) * (float)PI_base;
+		}
+
+#ifdef OPTION_PROBABILITY_X86
+
+		//AVX2 + FMA, 4 doubles per iteration
+		OPTION_PROBABILITY_TARGET("avx2,fma")
+		inline __m256d exp_avx2(__m256d v)
+		{
+			v = _mm256_max_pd(v, _mm256_set1_pd(exp_min));
+			__m256d k = _mm256_round_pd(_mm256_mul_pd(v, _mm256_set1_pd(log2e)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+			__m256d r = _mm256_fnmadd_pd(k, _mm256_set1_pd(ln2_hi), v);
+			r = _mm256_fnmadd_pd(k, _mm256_set1_pd(ln2_lo), r);
+
+			__m256d p = _mm256_set1_pd(E[0]);
+			for (int i = 1; i < 13; i++)
+				p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(E[i]));
+
+			__m256i ki = _mm256_cvtepi32_epi64(_mm256_cvtpd_epi32(k));	//2^k through the exponent bits
+			__m256i bits = _mm256_slli_epi64(_mm256_add_epi64(ki, _mm256_set1_epi64x(1023)), 52);
+			return _mm256_mul_pd(p, _mm256_castsi256_pd(bits));
+		}
+
+		OPTION_PROBABILITY_TARGET("avx2,fma")
+		inline __m256d gauss_avx2(__m256d x)
+		{
+			__m256d hi = _mm256_mul_pd(x, x);
+			__m256d lo = _mm256_fmsub_pd(x, x, hi);
+			__m256d e = exp_avx2(_mm256_mul_pd(_mm256_set1_pd(-0.5), hi));
+			return _mm256_fnmadd_pd(_mm256_mul_pd(_mm256_set1_pd(0.5), lo), e, e);
+		}
+
+		OPTION_PROBABILITY_TARGET("avx2,fma")
+		inline __m256d tail_avx2(__m256d x)
+		{
+			__m256d a = _mm256_andnot_pd(_mm256_set1_pd(-0.0), x);
+			__m256d e = gauss_avx2(a);
+
+			__m256d num = _mm256_set1_pd(P[0]);
+			for (int i = 1; i < 7; i++)
+				num = _mm256_fmadd_pd(num, a, _mm256_set1_pd(P[i]));
+			__m256d den = _mm256_set1_pd(Q[0]);
+			for (int i = 1; i < 8; i++)
+				den = _mm256_fmadd_pd(den, a, _mm256_set1_pd(Q[i]));
+			__m256d rational = _mm256_div_pd(_mm256_mul_pd(e, num), den);
+
+			__m256d below = _mm256_cmp_pd(a, _mm256_set1_pd(split), _CMP_LT_OQ);
+			__m256d t = rational;
+			if (_mm256_movemask_pd(below) != 0xf)				//continued fraction only when some lane needs it
+			{
+				__m256d b = _mm256_add_pd(a, _mm256_set1_pd(0.65));
+				for (int k = fraction_terms; k > 0; k--)
+					b = _mm256_add_pd(a, _mm256_div_pd(_mm256_set1_pd(k), b));
+				__m256d fraction = _mm256_mul_pd(_mm256_div_pd(e, b), _mm256_set1_pd(inv_sqrt_2pi));
+				t = _mm256_blendv_pd(fraction, rational, below);
+			}
+			return _mm256_andnot_pd(_mm256_cmp_pd(a, _mm256_set1_pd(cutoff), _CMP_GT_OQ), t);
+		}
+
+#ifndef OPTION_PROBABILITY_SIMPSON							//the CDF arrays go through the scalar N() otherwise
+		OPTION_PROBABILITY_TARGET("avx2,fma")
+		void N_avx2(const double* x, double* out, std::size_t count)
+		{
+			std::size_t i = 0;
+			for (; i + 4 <= count; i += 4)
+			{
+				__m256d v = _mm256_loadu_pd(x + i);
+				__m256d t = tail_avx2(v);
+				__m256d neg = _mm256_cmp_pd(v, _mm256_setzero_pd(), _CMP_LT_OQ);
+				_mm256_storeu_pd(out + i, _mm256_blendv_pd(_mm256_sub_pd(_mm256_set1_pd(1), t), t, neg));
+			}
+			N_rest(x + i, out + i, count - i);
+		}
+
+		OPTION_PROBABILITY_TARGET("avx2,fma")
+		void N_pair_avx2(const double* x, double* lower, double* upper, std::size_t count)
+		{
+			std::size_t i = 0;
+			for (; i + 4 <= count; i += 4)
+			{
+				__m256d v = _mm256_loadu_pd(x + i);
+				__m256d t = tail_avx2(v);
+				__m256d c = _mm256_sub_pd(_mm256_set1_pd(1), t);
+				__m256d neg = _mm256_cmp_pd(v, _mm256_setzero_pd(), _CMP_LT_OQ);
+				_mm256_storeu_pd(lower + i, _mm256_blendv_pd(c, t, neg));
+				_mm256_storeu_pd(upper + i, _mm256_blendv_pd(t, c, neg));
+			}
+			N_pair_rest(x + i, lower + i, upper + i, count - i);
+		}
+
+#endif
+
+		OPTION_PROBABILITY_TARGET("avx2,fma")
+		void n_avx2(const double* x, double* out, std::size_t count)
+		{
+			std::size_t i = 0;
+			for (; i + 4 <= count; i += 4)
+			{
+				__m256d v = _mm256_loadu_pd(x + i);
+				__m256d e = gauss_avx2(v);
+				__m256d under = _mm256_cmp_pd(_mm256_mul_pd(v, v), _mm256_set1_pd(-2 * exp_min), _CMP_GT_OQ);
+				_mm256_storeu_pd(out + i, _mm256_andnot_pd(under, _mm256_mul_pd(e, _mm256_set1_pd(PI_base))));
+			}
+			n_scalar(x + i, out + i, count - i);
+		}
+
+		//AVX2 + FMA, 8 floats per iteration
+		OPTION_PROBABILITY_TARGET("avx2,fma")
+		inline __m256 exp_avx2(__m256 v)
+		{
+			v = _mm256_max_ps(v, _mm256_set1_ps(exp_min_f));
+			__m256 k = _mm256_round_ps(_mm256_mul_ps(v, _mm256_set1_ps((float)log2e)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+			__m256 r = _mm256_fnmadd_ps(k, _mm256_set1_ps(ln2_hi_f), v);
+			r = _mm256_fnmadd_ps(k, _mm256_set1_ps(ln2_lo_f), r);
+
+			__m256 p = _mm256_set1_ps((float)E[12 - exp_degree_f]);
+			for (int i = 13 - exp_degree_f; i < 13; i++)
+				p = _mm256_fmadd_ps(p, r, _mm256_set1_ps((float)E[i]));
+
+			__m256i bits = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(k), _mm256_set1_epi32(127)), 23);
+			return _mm256_mul_ps(p, _mm256_castsi256_ps(bits));
+		}
+
+		OPTION_PROBABILITY_TARGET("avx2,fma")
+		inline __m256 gauss_avx2(__m256 x)
+		{
+			__m256 hi = _mm256_mul_ps(x, x);
+			__m256 lo = _mm256_fmsub_ps(x, x, hi);
+			__m256 e = exp_avx2(_mm256_mul_ps(_mm256_set1_ps(-0.5f), hi));
+			return _mm256_fnmadd_ps(_mm256_mul_ps(_mm256_set1_ps(0.5f), lo), e, e);
+		}
+
+		OPTION_PROBABILITY_TARGET("avx2,fma")
+		inline __m256 tail_avx2(__m256 x)
+		{
+			__m256 a = _mm256_andnot_ps(_mm256_set1_ps(-0.0f), x);
+			__m256 e = gauss_avx2(a);
+
+			__m256 num = _mm256_set1_ps((float)P[0]);
+			for (int i = 1; i < 7; i++)
+				num = _mm256_fmadd_ps(num, a, _mm256_set1_ps((float)P[i]));
+			__m256 den = _mm256_set1_ps((float)Q[0]);
+			for (int i = 1; i < 8; i++)
+				den = _mm256_fmadd_ps(den, a, _mm256_set1_ps((float)Q[i]));
+			__m256 rational = _mm256_div_ps(_mm256_mul_ps(e, num), den);
+
+			__m256 below = _mm256_cmp_ps(a, _mm256_set1_ps(split_f), _CMP_LT_OQ);
+			__m256 t = rational;
+			if (_mm256_movemask_ps(below) != 0xff)
+			{
+				__m256 b = _mm256_add_ps(a, _mm256_set1_ps(0.65f));
+				for (int k = fraction_terms_f; k > 0; k--)
+					b = _mm256_add_ps(a, _mm256_div_ps(_mm256_set1_ps((float)k), b));
+				__m256 fraction = _mm256_mul_ps(_mm256_div_ps(e, b), _mm256_set1_ps((float)inv_sqrt_2pi));
+				t = _mm256_blendv_ps(fraction, rational, below);
+			}
+			return _mm256_andnot_ps(_mm256_cmp_ps(a, _mm256_set1_ps(cutoff_f), _CMP_GT_OQ), t);
+		}
+
+		OPTION_PROBABILITY_TARGET("avx2,fma")
+		void N_avx2(const float* x, float* out, std::size_t count)
+		{
+			std::size_t i = 0;
+			for (; i + 8 <= count; i += 8)
+			{
+				__m256 v = _mm256_loadu_ps(x + i);
+				__m256 t = tail_avx2(v);
+				__m256 neg = _mm256_cmp_ps(v, _mm256_setzero_ps(), _CMP_LT_OQ);
+				_mm256_storeu_ps(out + i, _mm256_blendv_ps(_mm256_sub_ps(_mm256_set1_ps(1), t), t, neg));
+			}
+			N_scalar(x + i, out + i, count - i);
+		}
+
+		OPTION_PROBABILITY_TARGET("avx2,fma")
+		void N_pair_avx2(const float* x, float* lower, float* upper, std::size_t count)
+		{
+			std::size_t i = 0;
+			for (; i + 8 <= count; i += 8)
+			{
+				__m256 v = _mm256_loadu_ps(x + i);
+				__m256 t = tail_avx2(v);
+				__m256 c = _mm256_sub_ps(_mm256_set1_ps(1), t);
+				__m256 neg = _mm256_cmp_ps(v, _mm256_setzero_ps(), _CMP_LT_OQ);
+				_mm256_storeu_ps(lower + i, _mm256_blendv_ps(c, t, neg));
+				_mm256_storeu_ps(upper + i, _mm256_blendv_ps(t, c, neg));
+			}
+			N_pair_scalar(x + i, lower + i, upper + i, count - i);
+		}
+
+		OPTION_PROBABILITY_TARGET("avx2,fma")
+		void n_avx2(const float* x, float* out, std::size_t count)
+		{
+			std::size_t i = 0;
+			for (; i + 8 <= count; i += 8)
+			{
+				__m256 v = _mm256_loadu_ps(x + i);
+				__m256 e = gauss_avx2(v);
+				__m256 under = _mm256_cmp_ps(_mm256_mul_ps(v, v), _mm256_set1_ps(-2 * exp_min_f), _CMP_GT_OQ);
+				_mm256_storeu_ps(out + i, _mm256_andnot_ps(under, _mm256_mul_ps(e, _mm256_set1_ps((float)PI_base))));
+			}
+			n_scalar(x + i, out + i, count - i);
+		}
+
+		//AVX-512F, 8 doubles per iteration
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"	//GCC 12 warns on the _mm512_undefined_pd() inside the intrinsics
+#endif
+		OPTION_PROBABILITY_TARGET("avx512f")
+		inline __m512d exp_avx512(__m512d v)
+		{
+			v = _mm512_max_pd(v, _mm512_set1_pd(exp_min));
+			__m512d k = _mm512_roundscale_pd(_mm512_mul_pd(v, _mm512_set1_pd(log2e)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+			__m512d r = _mm512_fnmadd_pd(k, _mm512_set1_pd(ln2_hi), v);
+			r = _mm512_fnmadd_pd(k, _mm512_set1_pd(ln2_lo), r);
+
+			__m512d p = _mm512_set1_pd(E[0]);
+			for (int i = 1; i < 13; i++)
+				p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(E[i]));
+
+			return _mm512_scalef_pd(p, k);
+		}
+
+		OPTION_PROBABILITY_TARGET("avx512f")
+		inline __m512d gauss_avx512(__m512d x)
+		{
+			__m512d hi = _mm512_mul_pd(x, x);
+			__m512d lo = _mm512_fmsub_pd(x, x, hi);
+			__m512d e = exp_avx512(_mm512_mul_pd(_mm512_set1_pd(-0.5), hi));
+			return _mm512_fnmadd_pd(_mm512_mul_pd(_mm512_set1_pd(0.5), lo), e, e);
+		}
+
+		OPTION_PROBABILITY_TARGET("avx512f")
+		inline __m512d tail_avx512(__m512d x)
+		{
+			__m512d a = _mm512_abs_pd(x);
+			__m512d e = gauss_avx512(a);
+
+			__m512d num = _mm512_set1_pd(P[0]);
+			for (int i = 1; i < 7; i++)
+				num = _mm512_fmadd_pd(num, a, _mm512_set1_pd(P[i]));
+			__m512d den = _mm512_set1_pd(Q[0]);
+			for (int i = 1; i < 8; i++)
+				den = _mm512_fmadd_pd(den, a, _mm512_set1_pd(Q[i]));
+			__m512d rational = _mm512_div_pd(_mm512_mul_pd(e, num), den);
+
+			__mmask8 below = _mm512_cmp_pd_mask(a, _mm512_set1_pd(split), _CMP_LT_OQ);
+			__m512d t = rational;
+			if (below != 0xff)									//continued fraction only when some lane needs it
+			{
+				__m512d b = _mm512_add_pd(a, _mm512_set1_pd(0.65));
+				for (int k = fraction_terms; k > 0; k--)
+					b = _mm512_add_pd(a, _mm512_div_pd(_mm512_set1_pd(k), b));
+				__m512d fraction = _mm512_mul_pd(_mm512_div_pd(e, b), _mm512_set1_pd(inv_sqrt_2pi));
+				t = _mm512_mask_blend_pd(below, fraction, rational);
+			}
+			return _mm512_mask_blend_pd(_mm512_cmp_pd_mask(a, _mm512_set1_pd(cutoff), _CMP_GT_OQ), t, _mm512_setzero_pd());
+		}
+
+#ifndef OPTION_PROBABILITY_SIMPSON							//the CDF arrays go through the scalar N() otherwise
+		OPTION_PROBABILITY_TARGET("avx512f")
+		void N_avx512(const double* x, double* out, std::size_t count)
+		{
+			std::size_t i = 0;
+			for (; i + 8 <= count; i += 8)
+			{
+				__m512d v = _mm512_loadu_pd(x + i);
+				__m512d t = tail_avx512(v);
+				__mmask8 neg = _mm512_cmp_pd_mask(v, _mm512_setzero_pd(), _CMP_LT_OQ);
+				_mm512_storeu_pd(out + i, _mm512_mask_blend_pd(neg, _mm512_sub_pd(_mm512_set1_pd(1), t), t));
+			}
+			N_rest(x + i, out + i, count - i);
+		}
+
+		OPTION_PROBABILITY_TARGET("avx512f")
+		void N_pair_avx512(const double* x, double* lower, double* upper, std::size_t count)
+		{
+			std::size_t i = 0;
+			for (; i + 8 <= count; i += 8)
+			{
+				__m512d v = _mm512_loadu_pd(x + i);
+				__m512d t = tail_avx512(v);
+				__m512d c = _mm512_sub_pd(_mm512_set1_pd(1), t);
+				__mmask8 neg = _mm512_cmp_pd_mask(v, _mm512_setzero_pd(), _CMP_LT_OQ);
+				_mm512_storeu_pd(lower + i, _mm512_mask_blend_pd(neg, c, t));
+				_mm512_storeu_pd(upper + i, _mm512_mask_blend_pd(neg, t, c));
+			}
+			N_pair_rest(x + i, lower + i, upper + i, count - i);
+		}
+
+#endif
+
+		OPTION_PROBABILITY_TARGET("avx512f")
+		void n_avx512(const double* x, double* out, std::size_t count)
+		{
+			std::size_t i = 0;
+			for (; i + 8 <= count; i += 8)
+			{
+				__m512d v = _mm512_loadu_pd(x + i);
+				__m512d e = gauss_avx512(v);
+				__mmask8 under = _mm512_cmp_pd_mask(_mm512_mul_pd(v, v), _mm512_set1_pd(-2 * exp_min), _CMP_GT_OQ);
+				_mm512_storeu_pd(out + i, _mm512_mask_blend_pd(under, _mm512_mul_pd(e, _mm512_set1_pd(PI_base)), _mm512_setzero_pd()));
+			}
+			n_scalar(x + i, out + i, count - i);
+		}
+
+		//AVX-512F, 16 floats per iteration
+		OPTION_PROBABILITY_TARGET("avx512f")
+		inline __m512 exp_avx512(__m512 v)
+		{
+			v = _mm512_max_ps(v, _mm512_set1_ps(exp_min_f));
+			__m512 k = _mm512_roundscale_ps(_mm512_mul_ps(v, _mm512_set1_ps((float)log2e)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+			__m512 r = _mm512_fnmadd_ps(k, _mm512_set1_ps(ln2_hi_f), v);
+			r = _mm512_fnmadd_ps(k, _mm512_set1_ps(ln2_lo_f), r);
+
+			__m512 p = _mm512_set1_ps((float)E[12 - exp_degree_f]);
+			for (int i = 13 - exp_degree_f; i < 13; i++)
+				p = _mm512_fmadd_ps(p, r, _mm512_set1_ps((float)E[i]));
+
+			return _mm512_scalef_ps(p, k);
+		}
+
+		OPTION_PROBABILITY_TARGET("avx512f")
+		inline __m512 gauss_avx512(__m512 x)
+		{
+			__m512 hi = _mm512_mul_ps(x, x);
+			__m512 lo = _mm512_fmsub_ps(x, x, hi);
+			__m512 e = exp_avx512(_mm512_mul_ps(_mm512_set1_ps(-0.5f), hi));
+			return _mm512_fnmadd_ps(_mm512_mul_ps(_mm512_set1_ps(0.5f), lo), e, e);
+		}
+
+		OPTION_PROBABILITY_TARGET("avx512f")
+		inline __m512 tail_avx512(__m512 x)
+		{
+			__m512 a = _mm512_abs_ps(x);
+			__m512 e = gauss_avx512(a);
+
+			__m512 num = _mm512_set1_ps((float)P[0]);
+			for (int i = 1; i < 7; i++)
+				num = _mm512_fmadd_ps(num, a, _mm512_set1_ps((float)P[i]));
+			__m512 den = _mm512_set1_ps((float)Q[0]);
+			for (int i = 1; i < 8; i++)
+				den = _mm512_fmadd_ps(den, a, _mm512_set1_ps((float)Q[i]));
+			__m512 rational = _mm512_div_ps(_mm512_mul_ps(e, num), den);
+
+			__mmask16 below = _mm512_cmp_ps_mask(a, _mm512_set1_ps(split_f), _CMP_LT_OQ);
+			__m512 t = rational;
+			if (below != 0xffff)
+			{
+				__m512 b = _mm512_add_ps(a, _mm512_set1_ps(0.65f));
+				for (int k = fraction_terms_f; k > 0; k--)
+					b = _mm512_add_ps(a, _mm512_div_ps(_mm512_set1_ps((float)k), b));
+				__m512 fraction = _mm512_mul_ps(_mm512_div_ps(e, b), _mm512_set1_ps((float)inv_sqrt_2pi));
+				t = _mm512_mask_blend_ps(below, fraction, rational);
+			}
+			return _mm512_mask_blend_ps(_mm512_cmp_ps_mask(a, _mm512_set1_ps(cutoff_f), _CMP_GT_OQ), t, _mm512_setzero_ps());
+		}
+
+		OPTION_PROBABILITY_TARGET("avx512f")
+		void N_avx512(const float* x, float* out, std::size_t count)
+		{
+			std::size_t i = 0;
+			for (; i + 16 <= count; i += 16)
+			{
+				__m512 v = _mm512_loadu_ps(x + i);
+				__m512 t = tail_avx512(v);
+				__mmask16 neg = _mm512_cmp_ps_mask(v, _mm512_setzero_ps(), _CMP_LT_OQ);
+				_mm512_storeu_ps(out + i, _mm512_mask_blend_ps(neg, _mm512_sub_ps(_mm512_set1_ps(1), t), t));
+			}
+			N_scalar(x + i, out + i, count - i);
+		}
+
+		OPTION_PROBABILITY_TARGET("avx512f")
+		void N_pair_avx512(const float* x, float* lower, float* upper, std::size_t count)
+		{
+			std::size_t i = 0;
+			for (; i + 16 <= count; i += 16)
+			{
+				__m512 v = _mm512_loadu_ps(x + i);
+				__m512 t = tail_avx512(v);
+				__m512 c = _mm512_sub_ps(_mm512_set1_ps(1), t);
+				__mmask16 neg = _mm512_cmp_ps_mask(v, _mm512_setzero_ps(), _CMP_LT_OQ);
+				_mm512_storeu_ps(lower + i, _mm512_mask_blend_ps(neg, c, t));
+				_mm512_storeu_ps(upper + i, _mm512_mask_blend_ps(neg, t, c));
+			}
+			N_pair_scalar(x + i, lower + i, upper + i, count - i);
+		}
+
+		OPTION_PROBABILITY_TARGET("avx512f")
+		void n_avx512(const float* x, float* out, std::size_t count)
+		{
+			std::size_t i = 0;
+			for (; i + 16 <= count; i += 16)
+			{
+				__m512 v = _mm512_loadu_ps(x + i);
+				__m512 e = gauss_avx512(v);
+				__mmask16 under = _mm512_cmp_ps_mask(_mm512_mul_ps(v, v), _mm512_set1_ps(-2 * exp_min_f), _CMP_GT_OQ);
+				_mm512_storeu_ps(out + i, _mm512_mask_blend_ps(under, _mm512_mul_ps(e, _mm512_set1_ps((float)PI_base)), _mm512_setzero_ps()));
+			}
+			n_scalar(x + i, out + i, count - i);
+		}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+		Simd detect()
+		{
+#if defined(__GNUC__) || defined(__clang__)
+			__builtin_cpu_init();
+			if (__builtin_cpu_supports("avx512f"))
+				return Simd::AVX512;
+			if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+				return Simd::AVX2;
+			return Simd::Scalar;
+#elif defined(_MSC_VER)
+			int info[4];
+			__cpuid(info, 1);
+			bool fma = (info[2] >> 12) & 1;
+			bool osxsave = (info[2] >> 27) & 1;
+			if (!osxsave)
+				return Simd::Scalar;
+			unsigned long long xcr0 = _xgetbv(0);			//the OS has to save the wide registers too
+			__cpuidex(info, 7, 0);
+			if (((info[1] >> 16) & 1) && (xcr0 & 0xe6) == 0xe6)
+				return Simd::AVX512;
+			if (((info[1] >> 5) & 1) && fma && (xcr0 & 0x6) == 0x6)
+				return Simd::AVX2;
+			return Simd::Scalar;
+#else
+			return Simd::Scalar;
+#endif
+		}
+
+#else
+
+		Simd detect() { return Simd::Scalar; }
+
+#endif
+
+		Simd supported()
+		{
+			static const Simd level = detect();
+			return level;
+		}
+
+		std::atomic<int> forced(-1);						//-1 - use the best supported kernel
+
+	}
+
+	Simd simd_supported() { return supported(); }
+
+	Simd simd_level()
+	{
+		int f = forced.load(std::memory_order_relaxed);
+		return f < 0 ? supported() : (Simd)f;
+	}
+
+	void simd_level(Simd level)
+	{
+		if ((int)level > (int)supported())
+			level = supported();
+		forced.store((int)level, std::memory_order_relaxed);
+	}
+
+	const char* simd_name(Simd level)
+	{
+		switch (level)
+		{
+		case Simd::AVX512: return "avx512";
+		case Simd::AVX2: return "avx2";
+		default: return "scalar";
+		}
+	}
+
+	void N(const double* x, double* out, std::size_t count)
+	{
+#if defined(OPTION_PROBABILITY_X86) && !defined(OPTION_PROBABILITY_SIMPSON)
+		switch (simd_level())
+		{
+		case Simd::AVX512: N_avx512(x, out, count); return;
+		case Simd::AVX2: N_avx2(x, out, count); return;
+		default: break;
+		}
+#endif
+		for (std::size_t i = 0; i < count; i++)
+			out[i] = N(x[i]);
+	}
+
+	void N_pair(const double* x, double* lower, double* upper, std::size_t count)
+	{
+#if defined(OPTION_PROBABILITY_X86) && !defined(OPTION_PROBABILITY_SIMPSON)
+		switch (simd_level())
+		{
+		case Simd::AVX512: N_pair_avx512(x, lower, upper, count); return;
+		case Simd::AVX2: N_pair_avx2(x, lower, upper, count); return;
+		default: break;
+		}
+#endif
+		for (std::size_t i = 0; i < count; i++)
+			N_pair(x[i], lower[i], upper[i]);
+	}
+
+	void n(const double* x, double* out, std::size_t count)
+	{
+		switch (simd_level())
+		{
+#ifdef OPTION_PROBABILITY_X86
+		case Simd::AVX512: n_avx512(x, out, count); break;
+		case Simd::AVX2: n_avx2(x, out, count); break;
+#endif
+		default: n_scalar(x, out, count);
+		}
+	}
+
+	void N(const float* x, float* out, std::size_t count)
+	{
+		switch (simd_level())
+		{
+#ifdef OPTION_PROBABILITY_X86
+		case Simd::AVX512: N_avx512(x, out, count); break;
+		case Simd::AVX2: N_avx2(x, out, count); break;
+#endif
+		default: N_scalar(x, out, count);
+		}
+	}
+
+	void N_pair(const float* x, float* lower, float* upper, std::size_t count)
+	{
+		switch (simd_level())
+		{
+#ifdef OPTION_PROBABILITY_X86
+		case Simd::AVX512: N_pair_avx512(x, lower, upper, count); break;
+		case Simd::AVX2: N_pair_avx2(x, lower, upper, count); break;
+#endif
+		default: N_pair_scalar(x, lower, upper, count);
+		}
+	}
+
+	void n(const float* x, float* out, std::size_t count)
+	{
+		switch (simd_level())
+		{
+#ifdef OPTION_PROBABILITY_X86
+		case Simd::AVX512: n_avx512(x, out, count); break;
+		case Simd::AVX2: n_avx2(x, out, count); break;
+#endif
+		default: n_scalar(x, out, count);
+		}
+	}
+
+}
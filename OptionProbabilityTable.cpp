@@ -0,0 +1,170 @@
+//Table based normal CDF/PDF for the latency bound scalar path
+//
+//The tail N(-a), a = |x|, and the PDF are tabulated at a = i / 32 on [0, 8.5] and interpolated with
+//quintic Hermite polynomials, which match value, first and second derivative at both nodes (the
+//derivatives of the tail are -n(a) and a * n(a), of the PDF -a * n(a) and (a^2 - 1) * n(a), so the nodes
+//carry everything). Each interval stores its polynomial in powers of t = 32 * (a - node), one lookup and
+//5 multiply-adds per call. The nodes and coefficients are computed by constexpr functions, the tables
+//are built by the compiler and cost nothing at startup; 2 x 272 x 6 doubles = 26 KB.
+//Beyond 8.5 the tail is n(a) over the same continued fraction the array kernels use, 0 beyond 37.
+
+#include "OptionProbability.hpp"
+
+namespace OptionProbability {
+
+	namespace {
+
+		constexpr int table_steps = 32;					//nodes per unit of a, h = 1 / 32
+		constexpr double table_end = 8.5;
+		constexpr int table_intervals = 272;			//table_end * table_steps
+		constexpr int fraction_terms = 16;				//continued fraction of the tail beyond the table
+		constexpr double cutoff = 37;					//tail is 0 beyond
+		constexpr double inv_sqrt_2pi = 0.398942280401432677940;
+
+		//Compile time helpers, the <cmath> functions aren't constexpr
+
+		constexpr double cx_exp(double v)				//exp(v), v <= 0: 2^k * exp(r), |r| <= ln2 / 2, Taylor degree 20
+		{
+			constexpr double log2e = 1.4426950408889634074;
+			constexpr double ln2_hi = 6.93147180369123816490e-01;
+			constexpr double ln2_lo = 1.90821492927058770002e-10;
+
+			int k = (int)(v * log2e - 0.5);
+			double r = (v - k * ln2_hi) - k * ln2_lo;
+
+			double p = 1;
+			for (int i = 20; i > 0; i--)
+				p = 1 + p * r / i;
+
+			for (; k < 0; k++)							//exact scaling by powers of 2
+				p *= 0.5;
+			return p;
+		}
+
+		constexpr double cx_pdf(double a)				//a * a / 2 is exact for the nodes
+		{
+			return inv_sqrt_2pi * cx_exp(-a * a / 2);
+		}
+
+		constexpr double cx_tail(double a)				//N(-a), a >= 0
+		{
+			if (a < 2)									//Taylor series N(a) - 1/2 = n(a) * (a + a^3/3 + a^5/15 + ...)
+			{
+				double term = a, sum = a;
+				for (int k = 1; term > sum * 1e-18; k++)
+				{
+					term *= a * a / (2 * k + 1);
+					sum += term;
+				}
+				return 0.5 - cx_pdf(a) * sum;
+			}
+
+			double f = a;								//continued fraction n(a) / (a + 1/(a + 2/(a + 3/(a + ...)))),
+			for (int k = 2000; k > 0; k--)				//2000 terms converge to double precision from a = 2
+				f = a + k / f;
+			return cx_pdf(a) / f;
+		}
+
+		struct Table
+		{
+			double c[table_intervals][6];				//polynomial in t per interval, lowest power first
+		};
+
+		//Quintic Hermite interpolant between nodes a0 and a0 + h, f/d/s are the value, first and second
+		//derivative at the nodes. The remainders at t = 1 of the quadratic part give the top 3 coefficients.
+		constexpr void hermite(double* c, double f0, double d0, double s0, double f1, double d1, double s1, double h)
+		{
+			c[0] = f0;
+			c[1] = h * d0;
+			c[2] = h * h * s0 / 2;
+
+			double F = f1 - c[0] - c[1] - c[2];
+			double D = h * d1 - c[1] - 2 * c[2];
+			double S = h * h * s1 - 2 * c[2];
+
+			c[3] = 10 * F - 4 * D + S / 2;
+			c[4] = -15 * F + 7 * D - S;
+			c[5] = 6 * F - 3 * D + S / 2;
+		}
+
+		constexpr Table make_table(bool cdf)
+		{
+			Table t{};
+			const double h = 1.0 / table_steps;
+
+			double a0 = 0, n0 = cx_pdf(0), q0 = 0.5;
+			for (int i = 0; i < table_intervals; i++)
+			{
+				double a1 = (i + 1) * h;
+				double n1 = cx_pdf(a1);
+
+				if (cdf)
+				{
+					double q1 = cx_tail(a1);
+					hermite(t.c[i], q0, -n0, a0 * n0, q1, -n1, a1 * n1, h);
+					q0 = q1;
+				}
+				else
+					hermite(t.c[i], n0, -a0 * n0, (a0 * a0 - 1) * n0, n1, -a1 * n1, (a1 * a1 - 1) * n1, h);
+
+				a0 = a1;
+				n0 = n1;
+			}
+
+			return t;
+		}
+
+		constexpr Table cdf_table = make_table(true);
+		constexpr Table pdf_table = make_table(false);
+
+		inline double interpolate(const Table& table, double a)	//a in [0, table_end)
+		{
+			double u = a * table_steps;
+			int i = (int)u;
+			double t = u - i;
+			const double* c = table.c[i];
+
+			return c[0] + t * (c[1] + t * (c[2] + t * (c[3] + t * (c[4] + t * c[5]))));
+		}
+
+		double exp_half_square(double a)				//exp(-a^2 / 2) without the rounding error of a * a
+		{
+			double hi = (float)a;						//24 bits, hi * hi is exact
+			double lo = a - hi;
+			return exp(hi * hi / -2) * exp(-lo * (hi + lo / 2));
+		}
+
+	}
+
+	double table_cdf(double x)
+	{
+		double a = fabs(x);
+		double tail;
+
+		if (a < table_end)
+			tail = interpolate(cdf_table, a);
+		else if (a > cutoff)
+			tail = 0;
+		else													//also NaN
+		{
+			double f = a;
+			for (int k = fraction_terms; k > 0; k--)
+				f = a + k / f;
+			tail = inv_sqrt_2pi * exp_half_square(a) / f;
+		}
+
+		return (x < 0) ? tail : 1 - tail;
+	}
+
+	double table_pdf(double x)
+	{
+		double a = fabs(x);
+
+		if (a < table_end)
+			return interpolate(pdf_table, a);
+		if (a > 40)												//underflows to 0 anyway, keeps inf - inf out of exp_half_square
+			return 0;
+		return inv_sqrt_2pi * exp_half_square(a);
+	}
+
+}
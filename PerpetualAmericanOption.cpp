@@ -1,6 +1,9 @@
 //A perpetual american option class that can calculate option prices
 
 #include "PerpetualAmericanOption.hpp"
+#include "InputValidation.hpp"
+#include "Stats.hpp"
+#include <cassert>
 #include <cmath>
 
 PerpetualAmericanOption::PerpetualAmericanOption()							//default constructor has just initialized data members
@@ -33,64 +36,62 @@ void PerpetualAmericanOption::S(double newS)
 {
 	if (newS < 0)
 	{
-		std::cout << "Underlying price can't be negative, setting to 0.\n";
-		S_val = 0;
-	}
-	else
-		S_val = newS;
+		Stats::Add(Stats::ClampS);
+		S_val = InputValidation::default_perpetual_S;
+	} else S_val = newS;
 }
 
 void PerpetualAmericanOption::K(double newK)
 {
 	if (newK < 0)
 	{
-		std::cout << "Strike price can't be negative, setting to 0.\n";
-		K_val = 0;
-	}
-	else
-		K_val = newK;
+		Stats::Add(Stats::ClampK);
+		K_val = InputValidation::default_K;
+	} else K_val = newK;
 }
 
 void PerpetualAmericanOption::b(double newb)
 {
 	if (newb < 0)
 	{
-		std::cout << "Cost of carry can't be negative, setting to 5%.\n";
-		b_val = 0.05;
-	}
-	else
-		b_val = newb;
+		Stats::Add(Stats::Clampb);
+		b_val = InputValidation::default_b;
+	} else b_val = newb;
 }
 
 void PerpetualAmericanOption::r(double newr)
 {
 	if (newr < 0)
 	{
-		std::cout << "BS doesn't work with negative interest rate, setting to 5%.\n";
-		r_val = 0.05;
-	}
-	else
-		r_val = newr;
+		Stats::Add(Stats::Clampr);
+		r_val = InputValidation::default_r;
+	} else r_val = newr;
 }
 
 void PerpetualAmericanOption::vol(double newvol)
 {
 	if (newvol < 0)
 	{
-		std::cout << "Volatility can't be negative, setting to 30%.\n";
-		S_val = 0;
-	}
-	else
-		vol_val = newvol;
+		Stats::Add(Stats::Clampvol);
+		vol_val = InputValidation::default_vol;
+	} else vol_val = newvol;
 }
 
 void PerpetualAmericanOption::SetValues(const std::vector<double>& params)
 {
-	S_val = params[0];
-	K_val = params[1];
-	r_val = params[2];
-	b_val = params[3];
-	vol_val = params[4];
+	SetValues(params.data(), params.size());
+}
+
+void PerpetualAmericanOption::SetValues(const double* params, std::size_t count)	//same from an array through the setters, count has to be at least 5
+{
+	assert(count >= 5);
+	(void)count;											//not read otherwise, silences -Wunused-parameter with NDEBUG
+
+	S(params[0]);
+	K(params[1]);
+	r(params[2]);
+	b(params[3]);
+	vol(params[4]);
 }
 
 //Operator overloading
@@ -116,17 +117,31 @@ PerpetualAmericanOption::operator=(const PerpetualAmericanOption& src)		//assign
 //Option prices
 double PerpetualAmericanOption::Call() const								//get price for call option
 {
-	double y1 = 0.5 - b_val / (vol_val * vol_val) +
-		sqrt(pow(b_val / (vol_val * vol_val) - 0.5, 2) + 2 * r_val / (vol_val * vol_val));
-	
-	return (K_val / (y1 - 1)) * pow(((y1-1)/y1)*(S_val/K_val), y1);
+	return CallFormula<double>(S_val, K_val, r_val, b_val, vol_val);
 }
 
 double PerpetualAmericanOption::Put() const									//get price for put option
 {
-	double y2 = 0.5 - b_val / (vol_val * vol_val) -
-		sqrt(pow(b_val / (vol_val * vol_val) - 0.5, 2) + 2 * r_val / (vol_val * vol_val));
+	return PutFormula<double>(S_val, K_val, r_val, b_val, vol_val);
+}
 
-	return (K_val / (1 - y2)) * pow(((y2 - 1) / y2) * (S_val / K_val), y2);
+//Sensitivities by automatic differentiation: S is seeded as a dual number and the price formula
+//is evaluated once on it, a nested dual gives the second derivative
+double PerpetualAmericanOption::Delta() const
+{
+	Dual<double> S(S_val, 1);
+	if (type() == 'C')
+		return CallFormula<Dual<double>>(S, K_val, r_val, b_val, vol_val).der;
+	else
+		return PutFormula<Dual<double>>(S, K_val, r_val, b_val, vol_val).der;
 }
 
+double PerpetualAmericanOption::Gamma() const
+{
+	typedef Dual<Dual<double>> Dual2;
+	Dual2 S(Dual<double>(S_val, 1), Dual<double>(1, 0));
+	if (type() == 'C')
+		return CallFormula<Dual2>(S, K_val, r_val, b_val, vol_val).der.der;
+	else
+		return PutFormula<Dual2>(S, K_val, r_val, b_val, vol_val).der.der;
+}
@@ -1,6 +1,7 @@
 //A perpetual american option class that can calculate option prices
 
 #include "Option.hpp"
+#include "Dual.hpp"
 #include <iostream>
 
 #ifndef Perpetual_American_Option_HPP
@@ -35,6 +36,7 @@ public:
 	void b(double newb);
 	void vol(double newvol);
 	void SetValues(const std::vector<double>& params);//set values from a vector of parameters
+	void SetValues(const double* params, std::size_t count);//same from a plain array (used by matrix_eval)
 
 	//Operator overloading
 	PerpetualAmericanOption& operator=(const PerpetualAmericanOption& src);
@@ -42,6 +44,44 @@ public:
 	//Option prices
 	double Call() const;						//get price for call option
 	double Put() const;							//get price for put option
+
+	//Sensitivities by forward-mode automatic differentiation of the price formulas
+	double Delta() const;						//get delta value given the internal type
+	double Gamma() const;						//get gamma value given the internal type
+
+	//Price formulas templated on the number type (double, or Dual for automatic differentiation).
+	//With b >= r (y1 <= 1) early exercise never pays and the call is its y1 -> 1 limit S; with r = 0
+	//and b <= vol^2 / 2 (y2 = 0) the put is its y2 -> 0 limit K.
+	template<typename D>
+	static D CallFormula(const D& S, const D& K, const D& r, const D& b, const D& vol);
+	template<typename D>
+	static D PutFormula(const D& S, const D& K, const D& r, const D& b, const D& vol);
 };
 
+template<typename D>
+D PerpetualAmericanOption::CallFormula(const D& S, const D& K, const D& r, const D& b, const D& vol)
+{
+	using std::pow; using std::sqrt;
+	D v2 = vol * vol;
+	D c = b / v2 - 0.5;
+	D y1 = 0.5 - b / v2 + sqrt(c * c + 2 * r / v2);
+	if (value_of(y1) <= 1)						//the formula would take a power of a negative number
+		return S;
+
+	return (K / (y1 - 1)) * pow(((y1 - 1) / y1) * (S / K), y1);
+}
+
+template<typename D>
+D PerpetualAmericanOption::PutFormula(const D& S, const D& K, const D& r, const D& b, const D& vol)
+{
+	using std::pow; using std::sqrt;
+	D v2 = vol * vol;
+	D c = b / v2 - 0.5;
+	D y2 = 0.5 - b / v2 - sqrt(c * c + 2 * r / v2);
+	if (value_of(y2) >= 0)
+		return K;
+
+	return (K / (1 - y2)) * pow(((y2 - 1) / y2) * (S / K), y2);
+}
+
 #endif
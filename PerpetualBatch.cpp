@@ -0,0 +1,140 @@
+//Batch pricing for perpetual american options, contracts sharing (r, b, vol) share their exponents
+
+#include "PerpetualBatch.hpp"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace PerpetualBatch {
+
+	Exponents MakeExponents(double r, double b, double vol)		//same expressions as PerpetualAmericanOption::CallFormula/PutFormula
+	{
+		Exponents e;
+		e.r = r;
+		e.b = b;
+		e.vol = vol;
+
+		double v2 = vol * vol;
+		double c = b / v2 - 0.5;
+		double root = std::sqrt(c * c + 2 * r / v2);
+
+		e.y1 = 0.5 - b / v2 + root;
+		e.y2 = 0.5 - b / v2 - root;
+		e.log_a1 = std::log((e.y1 - 1) / e.y1);
+		e.log_a2 = std::log((e.y2 - 1) / e.y2);
+		e.f1 = 1 / (e.y1 - 1);
+		e.f2 = 1 / (1 - e.y2);
+		return e;
+	}
+
+	namespace {
+
+		struct Key												//bit patterns of (r, b, vol)
+		{
+			std::uint64_t bits[3];
+
+			bool operator==(const Key& o) const { return bits[0] == o.bits[0] && bits[1] == o.bits[1] && bits[2] == o.bits[2]; }
+		};
+
+		inline std::size_t hash(const Key& k)					//one multiply, the table only uses the low bits
+		{
+			std::uint64_t h = (k.bits[0] ^ (k.bits[1] << 21 | k.bits[1] >> 43) ^ (k.bits[2] << 42 | k.bits[2] >> 22)) *
+							  0x9E3779B97F4A7C15ull;
+			return (std::size_t)(h ^ (h >> 32));
+		}
+
+		class GroupIndex										//(r, b, vol) -> group number, open addressing with linear probing
+		{
+		private:
+			std::vector<Key> keys;
+			std::vector<std::size_t> ids;						//group + 1, 0 - empty slot
+			std::size_t used = 0;
+
+			void grow()
+			{
+				std::vector<Key> old_keys;
+				std::vector<std::size_t> old_ids;
+				old_keys.swap(keys);
+				old_ids.swap(ids);
+				keys.assign(old_keys.size() * 2, Key());
+				ids.assign(old_ids.size() * 2, 0);
+				for (std::size_t i = 0; i < old_ids.size(); i++)
+					if (old_ids[i])
+						place(old_keys[i], old_ids[i]);
+			}
+
+			std::size_t place(const Key& k, std::size_t id)	//slot of k, stores id there if k is new
+			{
+				std::size_t mask = ids.size() - 1;
+				std::size_t i = hash(k) & mask;
+				while (ids[i] && !(keys[i] == k))
+					i = (i + 1) & mask;
+				if (!ids[i])
+				{
+					keys[i] = k;
+					ids[i] = id;
+				}
+				return i;
+			}
+
+		public:
+			GroupIndex() : keys(16), ids(16, 0) {}
+
+			//Group number of k, or next if k wasn't seen before (then added with that number)
+			std::size_t find_or_add(const Key& k, std::size_t next)
+			{
+				if (2 * (used + 1) > ids.size())
+					grow();
+				std::size_t i = place(k, next + 1);
+				if (ids[i] == next + 1)
+					used++;
+				return ids[i] - 1;
+			}
+		};
+
+		inline Key make_key(double r, double b, double vol)
+		{
+			Key k;
+			std::memcpy(&k.bits[0], &r, sizeof(double));
+			std::memcpy(&k.bits[1], &b, sizeof(double));
+			std::memcpy(&k.bits[2], &vol, sizeof(double));
+			return k;
+		}
+
+		inline void price(const Exponents& e, double S, double K, double& call, double& put)
+		{
+			double lsk = std::log(S / K);
+			call = !(e.y1 <= 1) ? K * e.f1 * std::exp(e.y1 * (e.log_a1 + lsk)) : S;	//NaN exponents still give NaN
+			put = !(e.y2 >= 0) ? K * e.f2 * std::exp(e.y2 * (e.log_a2 + lsk)) : K;
+		}
+
+	}
+
+	void Group(const Exponents& e, const double* S, const double* K, double* call, double* put, std::size_t n)
+	{
+		for (std::size_t i = 0; i < n; i++)
+			price(e, S[i], K[i], call[i], put[i]);
+	}
+
+	void CallPut(const double* S, const double* K, const double* r, const double* b, const double* vol,
+				 double* call, double* put, std::size_t n)
+	{
+		GroupIndex index;
+		std::vector<Exponents> groups;
+		std::size_t g = 0;
+
+		for (std::size_t i = 0; i < n; i++)
+		{
+			if (i == 0 || r[i] != r[i - 1] || b[i] != b[i - 1] || vol[i] != vol[i - 1])	//same as the previous row - no lookup
+			{
+				g = index.find_or_add(make_key(r[i], b[i], vol[i]), groups.size());
+				if (g == groups.size())
+					groups.push_back(MakeExponents(r[i], b[i], vol[i]));
+			}
+
+			price(groups[g], S[i], K[i], call[i], put[i]);		//results stay in input order
+		}
+	}
+
+}
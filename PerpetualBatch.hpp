@@ -0,0 +1,46 @@
+//Batch pricing for perpetual american options, contracts sharing (r, b, vol) share their exponents
+//
+//The exponents y1/y2 of the perpetual formulas (and the constant factors built from them) depend only
+//on r, b and vol, so they are computed once per group. What is left per contract is
+//
+//	call = K / (y1 - 1) * exp(y1 * (log((y1 - 1) / y1) + log(S / K)))
+//	put  = K / (1 - y2) * exp(y2 * (log((y2 - 1) / y2) + log(S / K)))
+//
+//i.e. one log shared by the call and the put and one exp each, instead of two pow() calls. Outside
+//y1 > 1 (b >= r) the call is S and outside y2 < 0 (r = 0) the put is K, as in PerpetualAmericanOption.
+//Values are used as given (no clamping like PerpetualAmericanOption setters do), results agree with
+//PerpetualAmericanOption::Call()/Put() within 1e-14 relative.
+
+#include <cstddef>
+
+#ifndef Perpetual_Batch_HPP
+#define Perpetual_Batch_HPP
+
+namespace PerpetualBatch {
+
+	struct Exponents							//everything that depends only on (r, b, vol)
+	{
+		double r = 0;
+		double b = 0;
+		double vol = 0;
+		double y1 = 0;							//call exponent (> 1 unless b >= r)
+		double y2 = 0;							//put exponent (< 0 unless r = 0)
+		double log_a1 = 0;						//log((y1 - 1) / y1)
+		double log_a2 = 0;						//log((y2 - 1) / y2)
+		double f1 = 0;							//1 / (y1 - 1)
+		double f2 = 0;							//1 / (1 - y2)
+	};
+
+	Exponents MakeExponents(double r, double b, double vol);
+
+	//Call and put prices of n contracts sharing one set of exponents
+	void Group(const Exponents& e, const double* S, const double* K, double* call, double* put, std::size_t n);
+
+	//Call and put prices of n contracts in input order, exponents are computed once per distinct
+	//(r, b, vol) of the batch wherever its rows are (a hash lookup when the key changes from the previous row)
+	void CallPut(const double* S, const double* K, const double* r, const double* b, const double* vol,
+				 double* call, double* put, std::size_t n);
+
+}
+
+#endif
@@ -0,0 +1,143 @@
+//Bounded, thread-safe LRU cache of B-S results keyed on quantized contract parameters
+
+#include "PriceCache.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+std::size_t PriceCache::KeyHash::operator()(const Key& k) const		//64-bit mix of the five quantized values
+{
+	std::uint64_t h = 0x9E3779B97F4A7C15ull;
+	for (int i = 0; i < 5; i++)
+	{
+		h ^= (std::uint64_t)k.q[i] + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2);
+		h *= 0xBF58476D1CE4E5B9ull;
+	}
+	return (std::size_t)(h ^ (h >> 31));
+}
+
+//Constructors and destructor
+PriceCache::PriceCache(std::size_t capacity, int digits, std::size_t shard_count)
+	:shards(std::max<std::size_t>(std::min(shard_count, capacity), 1)), quantum(std::pow(10.0, -digits))
+{
+	std::size_t n = shards.size();
+	for (std::size_t i = 0; i < n; i++)						//capacity / n each, the first capacity % n get one more
+	{
+		Shard& s = shards[i];
+		s.capacity = std::max<std::size_t>(capacity / n + (i < capacity % n), 1);
+		s.index.reserve(s.capacity < 65536 ? s.capacity : 65536);	//no rehashing while the cache fills up
+	}
+}
+
+PriceCache::~PriceCache()
+{
+}
+
+PriceCache::Shard& PriceCache::shard_of(const Key& k)
+{
+	return shards[(KeyHash()(k) >> 7) % shards.size()];		//high bits - the low ones pick the map bucket
+}
+
+bool PriceCache::MakeKey(const double* params, Key& k) const
+{
+	const double limit = 4611686018427387904.0;				//2^62, llround is exact well below the int64 range
+	for (int i = 0; i < 5; i++)
+	{
+		double x = params[i] / quantum;
+		if (!(std::fabs(x) < limit))						//also NaN and inf
+			return false;
+		k.q[i] = std::llround(x);
+	}
+	return true;
+}
+
+void PriceCache::Dequantize(const Key& k, double* params) const
+{
+	for (int i = 0; i < 5; i++)
+		params[i] = k.q[i] * quantum;
+}
+
+bool PriceCache::Find(const Key& k, BlackScholesResult& out)
+{
+	Shard& s = shard_of(k);
+	std::lock_guard<std::mutex> lock(s.m);
+
+	auto it = s.index.find(k);
+	if (it == s.index.end())
+	{
+		miss_count.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	s.lru.splice(s.lru.begin(), s.lru, it->second);			//mark as most recently used
+	out = it->second->second;
+	hit_count.fetch_add(1, std::memory_order_relaxed);
+	return true;
+}
+
+void PriceCache::Insert(const Key& k, const BlackScholesResult& value)
+{
+	Shard& s = shard_of(k);
+	std::lock_guard<std::mutex> lock(s.m);
+
+	auto it = s.index.find(k);
+	if (it != s.index.end())								//another thread got there first
+	{
+		s.lru.splice(s.lru.begin(), s.lru, it->second);
+		return;
+	}
+
+	s.lru.emplace_front(k, value);
+	s.index.emplace(k, s.lru.begin());
+
+	if (s.lru.size() > s.capacity)						//drop the least recently used entry
+	{
+		s.index.erase(s.lru.back().first);
+		s.lru.pop_back();
+		eviction_count.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+BlackScholesResult PriceCache::Get(const double* params)
+{
+	Key k;
+	if (!MakeKey(params, k))
+		return black_scholes(params[4], params[1], params[0], params[3], params[2]);
+
+	BlackScholesResult res;
+	if (!Find(k, res))
+	{
+		double p[5];
+		Dequantize(k, p);
+		res = black_scholes(p[4], p[1], p[0], p[3], p[2]);
+		Insert(k, res);
+	}
+	return res;
+}
+
+//Counters
+std::uint64_t PriceCache::hits() const { return hit_count.load(); }
+std::uint64_t PriceCache::misses() const { return miss_count.load(); }
+std::uint64_t PriceCache::evictions() const { return eviction_count.load(); }
+
+std::size_t PriceCache::size()
+{
+	std::size_t n = 0;
+	for (Shard& s : shards)
+	{
+		std::lock_guard<std::mutex> lock(s.m);
+		n += s.lru.size();
+	}
+	return n;
+}
+
+std::string PriceCache::StatsText()
+{
+	std::uint64_t h = hits();
+	std::uint64_t m = misses();
+	char buf[200];
+	std::snprintf(buf, sizeof(buf), "cache: entries = %zu, hits = %llu, misses = %llu, evictions = %llu, hit rate = %.1f%%",
+				  size(), (unsigned long long)h, (unsigned long long)m, (unsigned long long)evictions(),
+				  (h + m) ? 100.0 * h / (h + m) : 0.0);
+	return buf;
+}
@@ -0,0 +1,88 @@
+//Bounded, thread-safe LRU cache of B-S results keyed on quantized contract parameters
+//
+//Each of T, K, vol, r, S is rounded to a multiple of 10^-digits, the rounded tuple is the key and
+//results are always computed for the rounded inputs, so a cached answer doesn't depend on which
+//request happened to fill the entry. Inputs that aren't finite or whose multiple of the quantum
+//reaches 2^62 have no key and are priced as they are, outside the cache. The cache is split into
+//shards by key hash, each shard has its own mutex and LRU list, so threads of the file mode or the
+//server rarely contend; the capacity is divided between the shards and their sizes add up to it.
+
+#include "BlackScholes.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#ifndef Price_Cache_HPP
+#define Price_Cache_HPP
+
+class PriceCache
+{
+public:
+	struct Key
+	{
+		std::int64_t q[5];						//quantized T, K, vol, r, S
+
+		bool operator==(const Key& o) const
+		{
+			return q[0] == o.q[0] && q[1] == o.q[1] && q[2] == o.q[2] && q[3] == o.q[3] && q[4] == o.q[4];
+		}
+	};
+
+	struct KeyHash
+	{
+		std::size_t operator()(const Key& k) const;
+	};
+
+private:
+	struct Shard
+	{
+		std::mutex m;
+		std::size_t capacity = 1;
+		std::list<std::pair<Key, BlackScholesResult>> lru;	//most recently used first
+		std::unordered_map<Key, std::list<std::pair<Key, BlackScholesResult>>::iterator, KeyHash> index;
+	};
+
+	std::vector<Shard> shards;
+	double quantum;
+
+	std::atomic<std::uint64_t> hit_count{ 0 };
+	std::atomic<std::uint64_t> miss_count{ 0 };
+	std::atomic<std::uint64_t> eviction_count{ 0 };
+
+	Shard& shard_of(const Key& k);
+
+public:
+	static const int default_digits = 8;
+	static const int max_digits = 12;						//keeps typical inputs well inside the 2^62 key range
+
+	//Constructors and destructor
+	PriceCache(std::size_t capacity, int digits = default_digits, std::size_t shard_count = 16);
+	PriceCache(const PriceCache& o) = delete;
+	virtual ~PriceCache();
+
+	PriceCache& operator=(const PriceCache& src) = delete;
+
+	//Quantization, params in the text input order T, K, vol, r, S
+	bool MakeKey(const double* params, Key& k) const;		//false - no key, don't cache these inputs
+	void Dequantize(const Key& k, double* params) const;	//the rounded parameters a key stands for
+
+	bool Find(const Key& k, BlackScholesResult& out);		//counts a hit or a miss
+	void Insert(const Key& k, const BlackScholesResult& value);
+
+	BlackScholesResult Get(const double* params);			//find, or price the rounded inputs and insert (the inputs
+															//as they are if they have no key)
+
+	//Counters
+	std::uint64_t hits() const;
+	std::uint64_t misses() const;
+	std::uint64_t evictions() const;
+	std::size_t size();
+	std::string StatsText();								//one line summary for --stats style output
+};
+
+#endif
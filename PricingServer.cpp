@@ -0,0 +1,612 @@
+//Long-running pricing server over stdin/stdout or a local Unix domain socket
+
+#include "PricingServer.hpp"
+#include "BatchFile.hpp"
+#include "BatchPricing.hpp"
+#include "InputValidation.hpp"
+#include "PriceCache.hpp"
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+	typedef std::chrono::steady_clock Clock;
+
+	class LatencyHistogram										//log-scale buckets, 1/8 octave wide (~9% resolution)
+	{
+	private:
+		static const int per_octave = 8;
+		static const int buckets = 48 * per_octave;			//up to 2^48 ns
+		std::size_t counts[buckets] = {};
+		std::size_t total = 0;
+		double sum = 0;
+		double max_val = 0;
+
+	public:
+		void add(double ns)
+		{
+			int b = (ns < 1) ? 0 : (int)(std::log2(ns) * per_octave);
+			counts[b < buckets ? b : buckets - 1]++;
+			total++;
+			sum += ns;
+			if (ns > max_val)
+				max_val = ns;
+		}
+
+		double percentile(double p) const					//upper edge of the bucket holding the p-th percentile
+		{
+			std::size_t rank = (std::size_t)std::ceil(p / 100 * total);
+			std::size_t seen = 0;
+			for (int b = 0; b < buckets; b++)
+			{
+				seen += counts[b];
+				if (seen >= rank && seen > 0)
+					return std::fmin(std::exp2((b + 1.0) / per_octave), max_val);
+			}
+			return 0;
+		}
+
+		std::size_t count() const { return total; }
+		double mean() const { return total ? sum / total : 0; }
+		double max() const { return max_val; }
+	};
+
+	class ConnectionCount										//socket connections still open, waited for at shutdown
+	{
+	private:
+		std::size_t live = 0;
+		std::mutex m;
+		std::condition_variable idle;
+
+	public:
+		void add()
+		{
+			std::lock_guard<std::mutex> lock(m);
+			live++;
+		}
+
+		void remove()
+		{
+			std::lock_guard<std::mutex> lock(m);
+			if (--live == 0)
+				idle.notify_all();
+		}
+
+		void wait_idle()
+		{
+			std::unique_lock<std::mutex> lock(m);
+			idle.wait(lock, [this] { return live == 0; });
+		}
+	};
+
+	class Session												//one client: stdin/stdout or a socket connection
+	{
+	private:
+		struct Outbox											//responses of a socket client, sent by its own writer thread
+		{														//so a client that stops reading can't stall the others
+			int fd;
+			ConnectionCount* connections;
+			std::string pending;
+			bool closed = false;								//the session is gone, send what's left and close
+			bool dropped = false;								//client went away or fell too far behind
+			std::mutex m;
+			std::condition_variable ready;
+		};
+
+		std::shared_ptr<Outbox> out;							//null for stdout
+
+		static void send_loop(std::shared_ptr<Outbox> box)
+		{
+			std::string buf;
+			std::unique_lock<std::mutex> lock(box->m);
+			while (true)
+			{
+				box->ready.wait(lock, [&box] { return !box->pending.empty() || box->closed; });
+				if (box->pending.empty())
+					break;
+				buf.swap(box->pending);
+				bool dropped = box->dropped;
+				lock.unlock();
+
+#ifndef _WIN32
+				std::size_t done = 0;
+				while (!dropped && done < buf.size())
+				{
+					ssize_t n = send(box->fd, buf.data() + done, buf.size() - done, MSG_NOSIGNAL);
+					if (n <= 0)
+						dropped = true;
+					else
+						done += (std::size_t)n;
+				}
+#endif
+				buf.clear();
+
+				lock.lock();
+				if (dropped)
+					box->dropped = true;
+			}
+			lock.unlock();
+
+#ifndef _WIN32
+			close(box->fd);
+#endif
+			box->connections->remove();
+		}
+
+	public:
+		static const std::size_t max_pending = 16 << 20;		//unsent bytes before a client is dropped
+
+		std::size_t next_id = 1;								//request counter, used by the reader only
+
+		Session() {}											//stdout
+		Session(int socket_fd, ConnectionCount& connections)	//the connection counts as open until everything is sent
+			:out(std::make_shared<Outbox>())
+		{
+			out->fd = socket_fd;
+			out->connections = &connections;
+			std::thread(send_loop, out).detach();
+		}
+
+		~Session()
+		{
+			if (!out)
+				return;
+			std::lock_guard<std::mutex> lock(out->m);
+			out->closed = true;
+			out->ready.notify_one();
+		}
+
+		void write(const std::string& buf)						//stdout blocks, a socket only queues
+		{
+			if (!out)
+			{
+				std::cout.write(buf.data(), buf.size());
+				std::cout.flush();
+				return;
+			}
+
+			std::lock_guard<std::mutex> lock(out->m);
+			if (out->dropped)									//a client that went away just loses its responses
+				return;
+			if (out->pending.size() + buf.size() > max_pending)	//not reading: drop it, which also ends its reader
+			{
+				out->dropped = true;
+				out->pending.clear();
+#ifndef _WIN32
+				shutdown(out->fd, SHUT_RDWR);
+#endif
+				return;
+			}
+			out->pending += buf;
+			out->ready.notify_one();
+		}
+	};
+
+	struct Request
+	{
+		enum Kind { Quote, Error, Stats, End };
+
+		Kind kind = Quote;
+		std::shared_ptr<Session> session;
+		std::size_t id = 0;
+		Clock::time_point arrived;
+		double params[5] = {};									//T K vol r S
+		const char* error = nullptr;
+		InputValidation::Status invalid = 0;					//fields replaced (Clamp) or refused (Reject, Abort)
+	};
+
+	class RequestQueue											//bounded FIFO, push blocks while full
+	{
+	private:
+		std::deque<Request> items;
+		std::size_t capacity;
+		std::mutex m;
+		std::condition_variable not_full;
+		std::condition_variable not_empty;
+
+	public:
+		explicit RequestQueue(std::size_t cap) : capacity(cap ? cap : 1) {}
+
+		void push(Request&& r)
+		{
+			std::unique_lock<std::mutex> lock(m);
+			not_full.wait(lock, [this] { return items.size() < capacity; });
+			items.push_back(std::move(r));
+			not_empty.notify_one();
+		}
+
+		void pop_batch(std::vector<Request>& out, std::size_t max_batch)	//wait for one request, take all queued up to max_batch
+		{
+			out.clear();
+			std::unique_lock<std::mutex> lock(m);
+			not_empty.wait(lock, [this] { return !items.empty(); });
+			while (!items.empty() && out.size() < max_batch)
+			{
+				out.push_back(std::move(items.front()));
+				items.pop_front();
+			}
+			not_full.notify_all();
+		}
+	};
+
+	struct BatchStats
+	{
+		std::size_t batches = 0;
+		std::size_t quotes = 0;
+	};
+
+	std::string stats_text(const LatencyHistogram& h, const BatchStats& b)
+	{
+		char buf[256];
+		std::snprintf(buf, sizeof(buf),
+					  "requests = %zu, p50 = %.1f us, p99 = %.1f us, max = %.1f us, mean = %.1f us, batches = %zu, avg batch = %.1f",
+					  h.count(), h.percentile(50) / 1e3, h.percentile(99) / 1e3, h.max() / 1e3, h.mean() / 1e3,
+					  b.batches, b.batches ? (double)b.quotes / b.batches : 0.0);
+		return buf;
+	}
+
+	bool is_blank_line(const char* begin, const char* end)
+	{
+		for (const char* p = begin; p < end; p++)
+			if (*p != ' ' && *p != '\t' && *p != '\r')
+				return false;
+		return true;
+	}
+
+	//Turn one request line into a queued request, returns false for "QUIT"
+	bool parse_request(const char* begin, const char* end, const std::shared_ptr<Session>& session,
+					   InputValidation::Policy policy, Request& req)
+	{
+		while (end > begin && (end[-1] == '\r' || end[-1] == ' '))
+			end--;
+
+		std::string word(begin, end);
+		if (word == "QUIT")
+			return false;
+
+		req.session = session;
+		req.arrived = Clock::now();
+
+		if (word == "STATS")
+		{
+			req.kind = Request::Stats;
+			return true;
+		}
+
+		req.id = session->next_id++;
+		req.error = ParseQuoteLine(begin, end, req.params);
+		req.kind = req.error ? Request::Error : Request::Quote;
+
+		if (!req.error)											//same validation pass as the file mode, one row
+		{
+			double* p = req.params;
+			InputValidation::European(&p[4], &p[1], &p[0], &p[3], &p[2], &req.invalid, 1, policy);
+			if (req.invalid && policy != InputValidation::Policy::Clamp)
+				req.kind = Request::Error;
+		}
+		return true;
+	}
+
+	//Pricing thread: price queued requests in batches and answer them in order
+	void price_loop(RequestQueue& queue, std::size_t max_batch, PriceCache* cache,
+					LatencyHistogram& latency, BatchStats& stats)
+	{
+		std::vector<Request> batch;
+		std::vector<double> cols[5];							//SoA inputs of the quotes to price, reused between batches
+		std::vector<double> res[10];							//SoA outputs
+		std::vector<BlackScholesResult> results;				//one per quote of the batch, from the cache or priced
+		std::vector<std::size_t> slots;							//results index of every priced quote
+		std::vector<std::pair<std::size_t, PriceCache::Key>> keys;	//batch position and cache key of the priced quotes that have one
+		std::vector<std::size_t> done;							//requests whose response is in buf but not written yet
+		std::string buf;
+
+		while (true)
+		{
+			queue.pop_batch(batch, max_batch);
+
+			for (std::vector<double>& c : cols)
+				c.clear();
+			results.clear();
+			slots.clear();
+			keys.clear();
+
+			for (const Request& r : batch)						//answer from the cache or queue for batch pricing
+			{
+				if (r.kind != Request::Quote)
+					continue;
+
+				results.emplace_back();
+				const double* p = r.params;
+				double rounded[5];
+
+				PriceCache::Key k;
+				if (cache && cache->MakeKey(r.params, k))		//no key - priced as is, outside the cache
+				{
+					if (cache->Find(k, results.back()))
+						continue;
+					cache->Dequantize(k, rounded);
+					keys.emplace_back(slots.size(), k);
+					p = rounded;
+				}
+
+				slots.push_back(results.size() - 1);
+				for (int c = 0; c < 5; c++)
+					cols[c].push_back(p[c]);
+			}
+
+			std::size_t n = cols[0].size();
+			for (std::vector<double>& c : res)
+				c.resize(n);
+
+			BatchPricing::GreekColumns g = { res[0].data(), res[1].data(), res[2].data(), res[3].data(), res[4].data(),
+											 res[5].data(), res[6].data(), res[7].data(), res[8].data(), res[9].data() };
+			BatchPricing::Greeks(cols[4].data(), cols[1].data(), cols[0].data(), cols[3].data(), cols[2].data(), g, n);
+
+			for (std::size_t j = 0; j < n; j++)
+			{
+				BlackScholesResult& r = results[slots[j]];
+				r.call = g.call[j];
+				r.put = g.put[j];
+				r.delta_call = g.delta_call[j];
+				r.delta_put = g.delta_put[j];
+				r.gamma = g.gamma[j];
+				r.vega = g.vega[j];
+				r.theta_call = g.theta_call[j];
+				r.theta_put = g.theta_put[j];
+				r.rho_call = g.rho_call[j];
+				r.rho_put = g.rho_put[j];
+			}
+			for (const std::pair<std::size_t, PriceCache::Key>& key : keys)
+				cache->Insert(key.second, results[slots[key.first]]);
+
+			if (!results.empty())
+			{
+				stats.batches++;
+				stats.quotes += results.size();
+			}
+
+			bool end = false;
+			std::size_t q = 0;
+			buf.clear();
+			done.clear();
+
+			auto flush = [&]()									//write buf to the session of the buffered requests
+			{
+				if (done.empty())
+					return;
+				batch[done[0]].session->write(buf);
+				Clock::time_point now = Clock::now();
+				for (std::size_t i : done)
+					latency.add(std::chrono::duration<double, std::nano>(now - batch[i].arrived).count());
+				buf.clear();
+				done.clear();
+			};
+
+			for (std::size_t i = 0; i < batch.size(); i++)
+			{
+				Request& r = batch[i];
+
+				if (!done.empty() && batch[done[0]].session != r.session)
+					flush();
+
+				switch (r.kind)
+				{
+				case Request::Quote:
+				{
+					const BlackScholesResult& v = results[q++];
+					AppendResultLine(buf, r.id, v.call, v.put);
+					buf.pop_back();
+					buf += ", Delta call = ";
+					AppendFixed(buf, v.delta_call);
+					buf += ", Delta put = ";
+					AppendFixed(buf, v.delta_put);
+					buf += ", Gamma = ";
+					AppendFixed(buf, v.gamma);
+					buf += ", Vega = ";
+					AppendFixed(buf, v.vega);
+					if (r.invalid)
+						buf += ", replaced: " + InputValidation::Describe(r.invalid);
+					buf += '\n';
+				}
+					done.push_back(i);
+					break;
+				case Request::Error:
+					buf += "Option #" + std::to_string(r.id) + ": error: " +
+						   (r.error ? std::string(r.error) : "invalid " + InputValidation::Describe(r.invalid)) + '\n';
+					done.push_back(i);
+					break;
+				case Request::Stats:
+					flush();
+					r.session->write(stats_text(latency, stats) + (cache ? "; " + cache->StatsText() : "") + '\n');
+					break;
+				case Request::End:
+					end = true;
+					break;
+				}
+			}
+			flush();
+			batch.clear();										//drop session references
+
+			if (end)
+				return;
+		}
+	}
+
+	void read_stdin(RequestQueue& queue, InputValidation::Policy policy)
+	{
+		std::shared_ptr<Session> session = std::make_shared<Session>();
+		std::string line;
+
+		while (std::getline(std::cin, line))
+		{
+			const char* begin = line.data();
+			const char* end = begin + line.size();
+			if (is_blank_line(begin, end))							//empty lines get no response
+				continue;
+
+			Request req;
+			if (!parse_request(begin, end, session, policy, req))
+				break;
+			queue.push(std::move(req));
+		}
+
+		Request end;
+		end.kind = Request::End;
+		queue.push(std::move(end));
+	}
+
+#ifndef _WIN32
+	void read_socket(RequestQueue& queue, int fd, ConnectionCount& connections, InputValidation::Policy policy)	//one detached thread per connection
+	{
+		std::shared_ptr<Session> session = std::make_shared<Session>(fd, connections);
+		std::vector<char> buf(1 << 16);
+		std::size_t have = 0;
+		bool discarding = false;								//inside a line longer than the buffer
+
+		while (true)
+		{
+			if (have == buf.size())								//a line longer than the buffer gets an error response,
+			{													//the rest of it is skipped up to its line break
+				Request req;
+				req.kind = Request::Error;
+				req.session = session;
+				req.arrived = Clock::now();
+				req.id = session->next_id++;
+				req.error = "line too long";
+				queue.push(std::move(req));
+				have = 0;
+				discarding = true;
+			}
+
+			ssize_t n = recv(fd, buf.data() + have, buf.size() - have, 0);
+			if (n <= 0)
+				return;
+			have += (std::size_t)n;
+
+			char* p = buf.data();
+			char* end = buf.data() + have;
+			if (discarding)
+			{
+				char* eol = (char*)memchr(p, '\n', end - p);
+				if (!eol)
+				{
+					have = 0;
+					continue;
+				}
+				p = eol + 1;
+				discarding = false;
+			}
+			while (char* eol = (char*)memchr(p, '\n', end - p))
+			{
+				if (!is_blank_line(p, eol))
+				{
+					Request req;
+					if (!parse_request(p, eol, session, policy, req))
+					{
+						shutdown(fd, SHUT_RD);
+						return;
+					}
+					queue.push(std::move(req));
+				}
+				p = eol + 1;
+			}
+
+			have = end - p;
+			memmove(buf.data(), p, have);
+		}
+	}
+#endif
+
+}
+
+int RunPricingServer(const PricingServerOptions& options)
+{
+	RequestQueue queue(options.queue_capacity);
+	LatencyHistogram latency;
+	BatchStats stats;
+	std::size_t max_batch = options.max_batch ? options.max_batch : 1;
+
+	std::thread pricer(price_loop, std::ref(queue), max_batch, options.cache, std::ref(latency), std::ref(stats));
+
+	int rc = 0;
+
+	if (options.socket_path.empty())
+		read_stdin(queue, options.policy);
+	else
+	{
+#ifdef _WIN32
+		std::cerr << "Unix domain sockets are not supported on this platform." << std::endl;
+		rc = 1;
+#else
+		int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+		sockaddr_un addr = {};
+		addr.sun_family = AF_UNIX;
+
+		if (listener < 0 || options.socket_path.size() >= sizeof(addr.sun_path))
+		{
+			std::cerr << "Error creating socket: " << options.socket_path << std::endl;
+			rc = 1;
+		}
+		else
+		{
+			memcpy(addr.sun_path, options.socket_path.c_str(), options.socket_path.size() + 1);
+
+			struct stat st;										//only a stale socket of an earlier run may be replaced
+			bool exists = lstat(options.socket_path.c_str(), &st) == 0;
+
+			if (exists && !S_ISSOCK(st.st_mode))
+			{
+				std::cerr << "Not a socket, refusing to replace: " << options.socket_path << std::endl;
+				rc = 1;
+			}
+			else if ((exists && unlink(options.socket_path.c_str()) != 0) ||
+					 bind(listener, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(listener, 64) != 0)
+			{
+				std::cerr << "Error listening on socket: " << options.socket_path << std::endl;
+				rc = 1;
+			}
+			else
+			{
+				ConnectionCount connections;					//threads are detached, a finished connection leaves nothing behind
+				while (true)
+				{
+					int fd = accept(listener, nullptr, nullptr);
+					if (fd < 0)
+						break;
+					connections.add();							//removed by the session's writer once it has closed fd
+					std::thread(read_socket, std::ref(queue), fd, std::ref(connections), options.policy).detach();
+				}
+				connections.wait_idle();						//let connected clients finish
+			}
+			close(listener);
+		}
+#endif
+		Request end;											//stop the pricing thread
+		end.kind = Request::End;
+		queue.push(std::move(end));
+	}
+
+	pricer.join();
+
+	std::cerr << "Pricing server: " << stats_text(latency, stats) << std::endl;
+	if (options.cache)
+		std::cerr << options.cache->StatsText() << std::endl;
+	return rc;
+}
@@ -0,0 +1,40 @@
+//Long-running pricing server: answers newline-delimited "T K vol r S" requests from stdin or from
+//clients of a local Unix domain socket, so desk tools don't pay process startup per quote
+//
+//Every request line gets one response line, in request order for each client:
+//	"Option #n: Call = ..., Put = ..., Delta call = ..., Delta put = ..., Gamma = ..., Vega = ..."
+//where n counts the requests of that client, or "Option #n: error: reason" for a bad line.
+//Requests go through the same InputValidation pass as the file mode: with the Clamp policy invalid fields
+//are replaced and the response ends with ", replaced: vol" (the names of those fields), with Reject or
+//Abort the response is "Option #n: error: invalid vol" and the connection stays open.
+//"STATS" returns a latency summary instead, "QUIT" closes the connection.
+//
+//Readers push parsed requests into a bounded queue and block while it is full (backpressure reaches
+//the client through the pipe/socket). One pricing thread takes everything that is queued, up to
+//max_batch requests, prices it as one SoA batch and hands the responses of each socket client to that
+//client's writer thread, so a client that stops reading doesn't hold up the others; one that falls more
+//than 16 MB of responses behind is disconnected. Latency is measured from the moment a request line is
+//read until its response is written (queued for sending, for sockets).
+
+#include "InputValidation.hpp"
+#include "PriceCache.hpp"
+#include <cstddef>
+#include <string>
+
+#ifndef Pricing_Server_HPP
+#define Pricing_Server_HPP
+
+struct PricingServerOptions
+{
+	std::string socket_path;					//empty - serve stdin/stdout, otherwise listen on this Unix socket
+	std::size_t queue_capacity = 4096;			//max requests waiting to be priced
+	std::size_t max_batch = 1024;				//max requests priced together
+	PriceCache* cache = nullptr;				//optional result cache, owned by the caller
+	InputValidation::Policy policy = InputValidation::Policy::Clamp;	//requests with invalid inputs
+};
+
+//Run until stdin is closed (stdin mode) or forever (socket mode), prints latency stats to stderr at exit.
+//Returns the process exit code.
+int RunPricingServer(const PricingServerOptions& options);
+
+#endif
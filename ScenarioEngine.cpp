@@ -0,0 +1,191 @@
+//Risk ladder: revalues a portfolio of european option positions over a 2D grid of spot and vol shocks
+
+#include "ScenarioEngine.hpp"
+#include "BatchPricing.hpp"
+#include "OptionProbability.hpp"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace ScenarioEngine {
+
+	namespace {
+
+		const std::size_t block = BatchPricing::block;
+
+		struct Partial								//sums of one thread over its range of positions
+		{
+			double base = 0;
+			std::vector<double> value, delta, gamma, vega;
+
+			explicit Partial(std::size_t cells) : value(cells), delta(cells), gamma(cells), vega(cells) {}
+		};
+
+		//positions [from, to) into part, log_move[i] = log(1 + spot_shocks[i]), move[i] = 1 + spot_shocks[i]
+		void run_range(const EuropeanOption* positions, const double* quantities, std::size_t from, std::size_t to,
+					   const std::vector<double>& log_move, const std::vector<double>& move,
+					   const std::vector<double>& vol_shocks, Partial& part)
+		{
+			std::size_t spots = move.size();
+
+			double S[block], lnS[block], lnK[block], DK[block], sqrtT[block], rT[block], halfT[block];	//spot/vol independent
+			double vol[block], q[block], sgn[block];
+			double vsT[block], inv_vsT[block], drift[block];	//per vol shock
+			double d1[block], N1[block], N2[block], pdf[block];	//per scenario
+
+			for (std::size_t start = from; start < to; start += block)
+			{
+				std::size_t m = std::min(block, to - start);
+
+				for (std::size_t i = 0; i < m; i++)
+				{
+					const EuropeanOption& o = positions[start + i];
+					double T = o.T();
+					double r = o.r();
+
+					S[i] = o.S();
+					lnS[i] = std::log(S[i]);
+					lnK[i] = std::log(o.K());
+					DK[i] = o.K() * std::exp(-r * T);
+					sqrtT[i] = std::sqrt(T);
+					rT[i] = r * T;
+					halfT[i] = T / 2;
+					vol[i] = o.vol();
+					q[i] = quantities[start + i];
+					sgn[i] = (o.type() == 'C') ? 1.0 : -1.0;	//put = -(S N(-d1) - DK N(-d2))
+				}
+
+				for (std::size_t i = 0; i < m; i++)	//unshocked value for the P&L
+				{
+					double v = vol[i] * sqrtT[i];
+					double d = (lnS[i] - lnK[i] + rT[i] + vol[i] * vol[i] * halfT[i]) / v;
+					N1[i] = sgn[i] * d;
+					N2[i] = sgn[i] * (d - v);
+				}
+				OptionProbability::N(N1, N1, m);
+				OptionProbability::N(N2, N2, m);
+				for (std::size_t i = 0; i < m; i++)
+					part.base += q[i] * sgn[i] * (S[i] * N1[i] - DK[i] * N2[i]);
+
+				for (std::size_t j = 0; j < vol_shocks.size(); j++)
+				{
+					for (std::size_t i = 0; i < m; i++)
+					{
+						double v = std::max(vol[i] + vol_shocks[j], min_vol);
+						vsT[i] = v * sqrtT[i];
+						inv_vsT[i] = 1 / vsT[i];
+						drift[i] = (lnS[i] - lnK[i] + rT[i] + v * v * halfT[i]) * inv_vsT[i];	//d1 without the spot move
+					}
+
+					for (std::size_t k = 0; k < spots; k++)
+					{
+						double lm = log_move[k];
+						double mv = move[k];
+						double value = 0, delta = 0, gamma = 0, vega = 0;
+
+						for (std::size_t i = 0; i < m; i++)
+						{
+							d1[i] = lm * inv_vsT[i] + drift[i];
+							N1[i] = sgn[i] * d1[i];
+							N2[i] = sgn[i] * (d1[i] - vsT[i]);
+						}
+						OptionProbability::N(N1, N1, m);		//whole block through the SIMD kernels
+						OptionProbability::N(N2, N2, m);
+						OptionProbability::n(d1, pdf, m);
+
+						for (std::size_t i = 0; i < m; i++)
+						{
+							double Sk = S[i] * mv;
+							value += q[i] * sgn[i] * (Sk * N1[i] - DK[i] * N2[i]);
+							delta += q[i] * sgn[i] * N1[i];
+							gamma += q[i] * pdf[i] * inv_vsT[i] / Sk;
+							vega += q[i] * Sk * pdf[i] * sqrtT[i];
+						}
+
+						std::size_t c = j * spots + k;
+						part.value[c] += value;
+						part.delta[c] += delta;
+						part.gamma[c] += gamma;
+						part.vega[c] += vega;
+					}
+				}
+			}
+		}
+
+	}
+
+	Cube Run(const EuropeanOption* positions, const double* quantities, std::size_t n,
+			 const std::vector<double>& spot_shocks, const std::vector<double>& vol_shocks, unsigned threads)
+	{
+		Cube cube;
+		cube.spot_shocks = spot_shocks;
+		cube.vol_shocks = vol_shocks;
+
+		std::size_t cells = spot_shocks.size() * vol_shocks.size();
+		std::vector<double> log_move, move;
+		for (double s : spot_shocks)
+		{
+			move.push_back(1 + s);
+			log_move.push_back(std::log1p(s));
+		}
+
+		if (threads == 0)
+			threads = std::thread::hardware_concurrency();
+		if (threads == 0)
+			threads = 1;
+
+		std::size_t blocks = (n + block - 1) / block;
+		if (threads > blocks)
+			threads = blocks ? (unsigned)blocks : 1;
+
+		std::size_t step = (blocks + threads - 1) / threads * block;	//whole blocks per thread
+		std::vector<Partial> parts(threads, Partial(cells));
+
+		if (threads == 1)
+			run_range(positions, quantities, 0, n, log_move, move, vol_shocks, parts[0]);
+		else
+		{
+			std::vector<std::thread> pool;
+			for (unsigned t = 0; t < threads; t++)
+			{
+				std::size_t from = std::min(n, t * step);
+				std::size_t to = std::min(n, from + step);
+				pool.emplace_back(run_range, positions, quantities, from, to, std::cref(log_move), std::cref(move),
+								  std::cref(vol_shocks), std::ref(parts[t]));
+			}
+			for (std::thread& t : pool)
+				t.join();
+		}
+
+		cube.value.assign(cells, 0);
+		cube.delta.assign(cells, 0);
+		cube.gamma.assign(cells, 0);
+		cube.vega.assign(cells, 0);
+
+		for (const Partial& p : parts)								//fixed order - same sums on every run
+		{
+			cube.base_value += p.base;
+			for (std::size_t c = 0; c < cells; c++)
+			{
+				cube.value[c] += p.value[c];
+				cube.delta[c] += p.delta[c];
+				cube.gamma[c] += p.gamma[c];
+				cube.vega[c] += p.vega[c];
+			}
+		}
+
+		cube.pnl.resize(cells);
+		for (std::size_t c = 0; c < cells; c++)
+			cube.pnl[c] = cube.value[c] - cube.base_value;
+
+		return cube;
+	}
+
+	Cube Run(const std::vector<EuropeanOption>& positions, const std::vector<double>& quantities,
+			 const std::vector<double>& spot_shocks, const std::vector<double>& vol_shocks, unsigned threads)
+	{
+		return Run(positions.data(), quantities.data(), std::min(positions.size(), quantities.size()),
+				   spot_shocks, vol_shocks, threads);
+	}
+
+}
@@ -0,0 +1,53 @@
+//Risk ladder: revalues a portfolio of european option positions over a 2D grid of spot and vol shocks
+//
+//Every scenario (spot shock i, vol shock j) moves all underlyings to S * (1 + spot_shocks[i]) and all
+//vols to vol + vol_shocks[j] (floored at min_vol), the cube holds the portfolio value, P&L against the
+//unshocked portfolio and quantity-weighted delta, gamma and vega at every point.
+//
+//Contracts are processed in blocks of BatchPricing::block: per block the spot independent terms
+//(discounted strike, sqrt(T), log(S)) are computed once and the vol dependent ones once per vol shock,
+//then reused across all spot shocks. Blocks are split between threads by contiguous ranges, each thread
+//sums into its own cube and the partial cubes are added in range order, so results don't depend on timing.
+//
+//Positions are used as given (S, K, T, r, vol from the EuropeanOption selectors, type() picks call or put),
+//spot shocks have to be greater than -1.
+
+#include "EuropeanOption.hpp"
+#include <cstddef>
+#include <vector>
+
+#ifndef Scenario_Engine_HPP
+#define Scenario_Engine_HPP
+
+namespace ScenarioEngine {
+
+	static const double min_vol = 1e-4;				//floor for shocked volatilities
+
+	struct Cube
+	{
+		std::vector<double> spot_shocks;			//relative, 0.05 = spot up 5%
+		std::vector<double> vol_shocks;				//absolute, 0.02 = vol up 2 points
+		double base_value = 0;						//portfolio value without shocks
+
+		//one value per scenario, element index(i, j) is spot shock i and vol shock j
+		std::vector<double> value;
+		std::vector<double> pnl;					//value - base_value
+		std::vector<double> delta;					//sum of quantity * dV/dS (per unit move of each underlying)
+		std::vector<double> gamma;
+		std::vector<double> vega;
+
+		std::size_t spots() const { return spot_shocks.size(); }
+		std::size_t vols() const { return vol_shocks.size(); }
+		std::size_t index(std::size_t spot, std::size_t vol) const { return vol * spot_shocks.size() + spot; }
+	};
+
+	//quantities[p] is the position size of positions[p] (negative for short), threads = 0 uses all hardware threads
+	Cube Run(const EuropeanOption* positions, const double* quantities, std::size_t n,
+			 const std::vector<double>& spot_shocks, const std::vector<double>& vol_shocks, unsigned threads = 1);
+
+	Cube Run(const std::vector<EuropeanOption>& positions, const std::vector<double>& quantities,
+			 const std::vector<double>& spot_shocks, const std::vector<double>& vol_shocks, unsigned threads = 1);
+
+}
+
+#endif
@@ -0,0 +1,121 @@
+//Static-dispatch option model layer, coexisting with the virtual Option interface
+//
+//Models are plain parameter structs deriving from StaticOption<Model> (CRTP) with inline Call()/Put().
+//The option type is a template parameter of Price<Type>(), so a loop over a homogeneous array of
+//contracts has neither a virtual call nor a per-contract type branch and compiles to straight-line
+//inlined code. Models convert from their EuropeanOption/PerpetualAmericanOption counterparts with an
+//explicit constructor and back with ToOption().
+
+#include "EuropeanOption.hpp"
+#include "PerpetualAmericanOption.hpp"
+#include <cstddef>
+
+#ifndef Static_Option_HPP
+#define Static_Option_HPP
+
+template<typename Model>
+struct StaticOption
+{
+	const Model& model() const { return static_cast<const Model&>(*this); }
+
+	template<char Type>
+	double Price() const										//'C' or 'P' chosen at compile time
+	{
+		static_assert(Type == 'C' || Type == 'P', "option type has to be 'C' or 'P'");
+		if constexpr (Type == 'C')
+			return model().Call();
+		else
+			return model().Put();
+	}
+
+	double Price(char type) const								//runtime type, same convention as Option::type()
+	{
+		return (type == 'C') ? model().Call() : model().Put();
+	}
+};
+
+struct EuropeanModel : StaticOption<EuropeanModel>				//B-S european option, same formulas as EuropeanOption
+{
+	double S = 0;
+	double K = 0;
+	double T = 1;
+	double r = 0.05;
+	double vol = 0.3;
+
+	EuropeanModel() {}
+	EuropeanModel(double newS, double newK, double newT, double newr, double newvol)
+		:S(newS), K(newK), T(newT), r(newr), vol(newvol)
+	{
+	}
+	explicit EuropeanModel(const EuropeanOption& o)
+		:S(o.S()), K(o.K()), T(o.T()), r(o.r()), vol(o.vol())
+	{
+	}
+
+	EuropeanOption ToOption() const								//through the setters, which clamp invalid values
+	{
+		EuropeanOption o;
+		o.S(S);
+		o.K(K);
+		o.T(T);
+		o.r(r);
+		o.vol(vol);
+		return o;
+	}
+
+	double Call() const { return EuropeanOption::CallFormula<double>(S, K, T, r, vol); }
+	double Put() const { return EuropeanOption::PutFormula<double>(S, K, T, r, vol); }
+};
+
+struct PerpetualAmericanModel : StaticOption<PerpetualAmericanModel>	//same formulas as PerpetualAmericanOption
+{
+	double S = 0;
+	double K = 0;
+	double r = 0.05;
+	double b = 0.06;
+	double vol = 0.3;
+
+	PerpetualAmericanModel() {}
+	PerpetualAmericanModel(double newS, double newK, double newr, double newb, double newvol)
+		:S(newS), K(newK), r(newr), b(newb), vol(newvol)
+	{
+	}
+	explicit PerpetualAmericanModel(const PerpetualAmericanOption& o)
+		:S(o.S()), K(o.K()), r(o.r()), b(o.b()), vol(o.vol())
+	{
+	}
+
+	PerpetualAmericanOption ToOption() const					//through the setters, which clamp invalid values
+	{
+		PerpetualAmericanOption o;
+		o.S(S);
+		o.K(K);
+		o.r(r);
+		o.b(b);
+		o.vol(vol);
+		return o;
+	}
+
+	double Call() const { return PerpetualAmericanOption::CallFormula<double>(S, K, r, b, vol); }
+	double Put() const { return PerpetualAmericanOption::PutFormula<double>(S, K, r, b, vol); }
+};
+
+//Price n contracts of one model and one type known at compile time
+template<char Type, typename Model>
+void PriceAll(const Model* contracts, double* out, std::size_t n)
+{
+	for (std::size_t i = 0; i < n; i++)
+		out[i] = contracts[i].template Price<Type>();
+}
+
+//Same with the type known at run time: the branch is taken once, outside the loop
+template<typename Model>
+void PriceAll(const Model* contracts, char type, double* out, std::size_t n)
+{
+	if (type == 'C')
+		PriceAll<'C'>(contracts, out, n);
+	else
+		PriceAll<'P'>(contracts, out, n);
+}
+
+#endif
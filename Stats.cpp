@@ -0,0 +1,112 @@
+//Low-overhead counters and stage timers behind the --stats flag
+
+#include "Stats.hpp"
+#include <cstdio>
+
+namespace Stats {
+
+#ifndef OPTION_CALCULATOR_NO_STATS
+
+	void Reset()
+	{
+		for (std::atomic<std::uint64_t>& c : counters)
+			c.store(0, std::memory_order_relaxed);
+		for (int s = 0; s < StageCount; s++)
+		{
+			stage_ns[s].store(0, std::memory_order_relaxed);
+			stage_items[s].store(0, std::memory_order_relaxed);
+		}
+	}
+
+#else
+
+	void Reset() {}
+
+#endif
+
+	const char* Name(Counter c)
+	{
+		static const char* names[CounterCount] = { "simpson_calls", "simpson_refinements", "simpson_unconverged",
+												   "clamped_S", "clamped_K", "clamped_T", "clamped_r", "clamped_vol",
+												   "clamped_b", "clamped_q", "rejected_rows" };
+		return names[c];
+	}
+
+	const char* Name(Stage s)
+	{
+		static const char* names[StageCount] = { "parse", "price", "format", "write" };
+		return names[s];
+	}
+
+	namespace {
+
+		const char* unit(Stage s) { return s == Write ? "byte" : (s == Price ? "contract" : "line"); }
+
+	}
+
+	void Print(std::ostream& out, double wall_seconds)
+	{
+		char buf[200];
+
+		if (!Enabled())
+		{
+			out << "stats: not available (built with OPTION_CALCULATOR_NO_STATS)\n";
+			return;
+		}
+
+		std::snprintf(buf, sizeof(buf), "stats: wall time %.3f s\n", wall_seconds);
+		out << buf;
+
+		for (int s = 0; s < StageCount; s++)
+		{
+			std::uint64_t ns = Nanoseconds((Stage)s);
+			std::uint64_t n = Items((Stage)s);
+			if (!ns && !n)
+				continue;
+			std::snprintf(buf, sizeof(buf), "  %-6s %10.3f s  %12llu %ss  %8.2f ns/%s\n", Name((Stage)s), ns * 1e-9,
+						  (unsigned long long)n, unit((Stage)s), n ? (double)ns / n : 0.0, unit((Stage)s));
+			out << buf;
+		}
+
+		for (int c = 0; c < CounterCount; c++)
+		{
+			std::snprintf(buf, sizeof(buf), "  %-20s %12llu\n", Name((Counter)c), (unsigned long long)Get((Counter)c));
+			out << buf;
+		}
+
+		std::uint64_t calls = Get(SimpsonCalls);
+		if (calls)
+		{
+			std::snprintf(buf, sizeof(buf), "  simpson refinements per call %.2f\n", (double)Get(SimpsonRefinements) / calls);
+			out << buf;
+		}
+	}
+
+	void PrintJson(std::ostream& out, double wall_seconds)
+	{
+		char buf[200];
+
+		out << "{\n  \"enabled\": " << (Enabled() ? "true" : "false") << ",\n";
+		std::snprintf(buf, sizeof(buf), "  \"wall_seconds\": %.6f,\n", wall_seconds);
+		out << buf << "  \"stages\": {";
+
+		for (int s = 0; s < StageCount; s++)
+		{
+			std::snprintf(buf, sizeof(buf), "%s\n    \"%s\": {\"seconds\": %.6f, \"items\": %llu}", s ? "," : "",
+						  Name((Stage)s), Nanoseconds((Stage)s) * 1e-9, (unsigned long long)Items((Stage)s));
+			out << buf;
+		}
+
+		out << "\n  },\n  \"counters\": {";
+
+		for (int c = 0; c < CounterCount; c++)
+		{
+			std::snprintf(buf, sizeof(buf), "%s\n    \"%s\": %llu", c ? "," : "", Name((Counter)c),
+						  (unsigned long long)Get((Counter)c));
+			out << buf;
+		}
+
+		out << "\n  }\n}\n";
+	}
+
+}
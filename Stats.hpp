@@ -0,0 +1,110 @@
+//Low-overhead counters and stage timers behind the --stats flag
+//
+//Counters are relaxed atomics bumped only when the event happens (a Simpson refinement, an input
+//being clamped), so the common path costs nothing. Stage timers are read once per chunk of the
+//file mode, not per line, and accumulate thread time: with several workers parse + price can add up
+//to more than the wall time. Building with -DOPTION_CALCULATOR_NO_STATS turns every hook into an
+//empty inline function and the summary into a one-line note.
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+#ifndef Stats_HPP
+#define Stats_HPP
+
+namespace Stats {
+
+	enum Counter
+	{
+		SimpsonCalls,							//simpson_cdf() evaluations
+		SimpsonRefinements,						//interval doublings after the first two estimates
+		SimpsonUnconverged,						//calls that stopped at the refinement limit
+		ClampS,									//inputs replaced by the default (option setters, Clamp validation)
+		ClampK,
+		ClampT,
+		Clampr,
+		Clampvol,
+		Clampb,									//cost of carry, perpetual options
+		Clampq,									//dividend yield, american and lattice options
+		Rejected,								//rows left out by the Reject validation policy
+		CounterCount
+	};
+
+	enum Stage
+	{
+		Parse,									//text to validated parameters (items - lines)
+		Price,									//parameters to prices (items - contracts)
+		Format,									//prices to result lines (items - lines)
+		Write,									//formatted output to the stream (items - bytes)
+		StageCount
+	};
+
+	const char* Name(Counter c);
+	const char* Name(Stage s);
+
+#ifndef OPTION_CALCULATOR_NO_STATS
+
+	inline std::atomic<std::uint64_t> counters[CounterCount];		//inline variables, modules using the hooks
+	inline std::atomic<std::uint64_t> stage_ns[StageCount];		//don't need Stats.cpp to link
+	inline std::atomic<std::uint64_t> stage_items[StageCount];
+
+	inline void Add(Counter c, std::uint64_t v = 1) { counters[c].fetch_add(v, std::memory_order_relaxed); }
+
+	inline void AddTime(Stage s, std::uint64_t ns, std::uint64_t items)
+	{
+		stage_ns[s].fetch_add(ns, std::memory_order_relaxed);
+		stage_items[s].fetch_add(items, std::memory_order_relaxed);
+	}
+
+	class ScopedTimer							//adds the time between construction and destruction to a stage
+	{
+	private:
+		Stage stage;
+		std::uint64_t items;
+		std::chrono::steady_clock::time_point start;
+
+	public:
+		ScopedTimer(Stage s, std::uint64_t n) : stage(s), items(n), start(std::chrono::steady_clock::now()) {}
+		~ScopedTimer()
+		{
+			auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+			AddTime(stage, (std::uint64_t)ns, items);
+		}
+	};
+
+	inline std::uint64_t Get(Counter c) { return counters[c].load(std::memory_order_relaxed); }
+	inline std::uint64_t Nanoseconds(Stage s) { return stage_ns[s].load(std::memory_order_relaxed); }
+	inline std::uint64_t Items(Stage s) { return stage_items[s].load(std::memory_order_relaxed); }
+
+	inline bool Enabled() { return true; }
+
+#else
+
+	inline void Add(Counter, std::uint64_t = 1) {}
+	inline void AddTime(Stage, std::uint64_t, std::uint64_t) {}
+
+	class ScopedTimer
+	{
+	public:
+		ScopedTimer(Stage, std::uint64_t) {}
+	};
+
+	inline std::uint64_t Get(Counter) { return 0; }
+	inline std::uint64_t Nanoseconds(Stage) { return 0; }
+	inline std::uint64_t Items(Stage) { return 0; }
+
+	inline bool Enabled() { return false; }
+
+#endif
+
+	void Reset();
+
+	//Summary of every counter and stage, wall_seconds is the run time measured by the caller
+	void Print(std::ostream& out, double wall_seconds);
+	void PrintJson(std::ostream& out, double wall_seconds);
+
+}
+
+#endif
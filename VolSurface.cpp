@@ -0,0 +1,153 @@
+//Implied volatility surface on a strike x expiry grid, interpolated in total variance
+
+#include "VolSurface.hpp"
+#include "BatchPricing.hpp"
+#include <algorithm>
+#include <cmath>
+
+//Constructors and destructor
+VolSurface::VolSurface()
+{
+}
+
+VolSurface::~VolSurface()
+{
+}
+
+namespace {
+
+	bool strictly_increasing(const std::vector<double>& axis)	//also false for NaN nodes
+	{
+		return std::adjacent_find(axis.begin(), axis.end(), [](double a, double b) { return !(a < b); }) == axis.end();
+	}
+
+}
+
+//Modifiers
+bool VolSurface::Set(const std::vector<double>& newstrikes, const std::vector<double>& newexpiries,
+					 const std::vector<double>& vols)
+{
+	if (newstrikes.empty() || newexpiries.empty() || vols.size() != newstrikes.size() * newexpiries.size())
+		return false;
+	if (!strictly_increasing(newstrikes) || !strictly_increasing(newexpiries) || newexpiries[0] <= 0)
+		return false;										//a repeated node would give a zero-width interpolation interval
+
+	strikes = newstrikes;
+	expiries = newexpiries;
+	variance.resize(vols.size());
+
+	for (std::size_t j = 0; j < expiries.size(); j++)
+		for (std::size_t i = 0; i < strikes.size(); i++)
+		{
+			double v = vols[j * strikes.size() + i];
+			variance[j * strikes.size() + i] = v * v * expiries[j];
+		}
+
+	return true;
+}
+
+//Lookups
+std::size_t VolSurface::locate(const std::vector<double>& axis, double x, std::size_t hint)
+{
+	std::size_t n = axis.size();
+	if (n < 2)
+		return 0;
+
+	if (hint + 1 < n && axis[hint] <= x && x < axis[hint + 1])			//same cell as last time
+		return hint;
+	if (hint + 2 < n && axis[hint + 1] <= x && x < axis[hint + 2])		//next one (sorted chains)
+		return hint + 1;
+
+	std::size_t i = std::upper_bound(axis.begin(), axis.end(), x) - axis.begin();
+	if (i == 0)
+		return 0;
+	return std::min(i - 1, n - 2);
+}
+
+double VolSurface::slice(std::size_t j, std::size_t i, double K) const
+{
+	const double* w = variance.data() + j * strikes.size();
+
+	if (strikes.size() < 2 || K <= strikes[0])
+		return w[0];
+	if (K >= strikes.back())
+		return w[strikes.size() - 1];
+
+	double t = (K - strikes[i]) / (strikes[i + 1] - strikes[i]);
+	return w[i] + t * (w[i + 1] - w[i]);
+}
+
+double VolSurface::TotalVariance(double K, double T, Hint& hint) const
+{
+	if (variance.empty())
+		return 0;
+
+	hint.strike = locate(strikes, K, hint.strike);
+	std::size_t i = hint.strike;
+
+	if (T <= expiries[0])													//flat vol before the first slice
+		return slice(0, i, K) * T / expiries[0];
+	if (T >= expiries.back())												//and after the last one
+		return slice(expiries.size() - 1, i, K) * T / expiries.back();
+
+	hint.expiry = locate(expiries, T, hint.expiry);
+	std::size_t j = hint.expiry;
+
+	double t = (T - expiries[j]) / (expiries[j + 1] - expiries[j]);
+	double w0 = slice(j, i, K);
+	return w0 + t * (slice(j + 1, i, K) - w0);
+}
+
+double VolSurface::TotalVariance(double K, double T) const
+{
+	Hint hint;
+	return TotalVariance(K, T, hint);
+}
+
+double VolSurface::Vol(double K, double T, Hint& hint) const
+{
+	if (T <= 0)
+		return 0;
+	return std::sqrt(TotalVariance(K, T, hint) / T);
+}
+
+double VolSurface::Vol(double K, double T) const
+{
+	Hint hint;
+	return Vol(K, T, hint);
+}
+
+//Selectors
+bool VolSurface::empty() const { return variance.empty(); }
+std::size_t VolSurface::Strikes() const { return strikes.size(); }
+std::size_t VolSurface::Expiries() const { return expiries.size(); }
+
+//Batch queries
+void VolSurface::Vols(const double* K, const double* T, double* out, std::size_t n) const
+{
+	Hint hint;
+	for (std::size_t i = 0; i < n; i++)
+		out[i] = Vol(K[i], T[i], hint);
+}
+
+void VolSurface::PriceChain(double S, double r, const double* K, const double* T, double* call, double* put,
+							std::size_t n) const
+{
+	const std::size_t block = BatchPricing::block;
+	double S_col[block];
+	double r_col[block];
+	double vol[block];
+	std::fill(S_col, S_col + block, S);
+	std::fill(r_col, r_col + block, r);
+
+	Hint hint;
+	for (std::size_t start = 0; start < n; start += block)
+	{
+		std::size_t m = std::min(block, n - start);
+
+		for (std::size_t i = 0; i < m; i++)
+			vol[i] = Vol(K[start + i], T[start + i], hint);
+
+		BatchPricing::CallPut(S_col, K + start, T + start, r_col, vol, call + start, put + start, m);
+	}
+}
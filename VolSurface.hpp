@@ -0,0 +1,61 @@
+//Implied volatility surface on a strike x expiry grid, interpolated in total variance
+//
+//Total variance w = vol^2 * T is stored per node. Inside a slice w is linear in strike (flat beyond the
+//first/last strike), between slices it is linear in T, so the surface has no calendar arbitrage as long
+//as the slices don't cross. Before the first expiry and after the last one the vol of the nearest slice
+//is kept. A lookup is a binary search on each axis (O(log n)), the hinted variants first try the cell of
+//the previous lookup and its neighbour, so walking a chain sorted by strike is O(1) per contract.
+//
+//PriceChain looks vols up and prices a chain block by block (BatchPricing::block contracts at a time),
+//the vols of a block go straight into the batch kernel without an intermediate vol column.
+
+#include <cstddef>
+#include <vector>
+
+#ifndef Vol_Surface_HPP
+#define Vol_Surface_HPP
+
+class VolSurface
+{
+private:
+	std::vector<double> strikes;				//ascending
+	std::vector<double> expiries;				//ascending, positive
+	std::vector<double> variance;				//variance[j * strikes.size() + i] = vol^2 * T at expiries[j], strikes[i]
+
+	static std::size_t locate(const std::vector<double>& axis, double x, std::size_t hint);	//cell [i, i + 1] holding x
+	double slice(std::size_t j, std::size_t i, double K) const;								//w of slice j at K in cell i
+
+public:
+	struct Hint									//cells of the previous lookup
+	{
+		std::size_t strike = 0;
+		std::size_t expiry = 0;
+	};
+
+	//Constructors and destructor
+	VolSurface();
+	virtual ~VolSurface();
+
+	//Modifiers
+	bool Set(const std::vector<double>& newstrikes, const std::vector<double>& newexpiries,	//vols[j * strikes + i] is the vol at
+			 const std::vector<double>& vols);												//expiry j and strike i, false if the
+																							//shape is wrong or an axis is not
+																							//strictly increasing
+	//Selectors
+	bool empty() const;
+	std::size_t Strikes() const;
+	std::size_t Expiries() const;
+
+	double TotalVariance(double K, double T) const;
+	double TotalVariance(double K, double T, Hint& hint) const;
+	double Vol(double K, double T) const;
+	double Vol(double K, double T, Hint& hint) const;
+
+	//Batch queries
+	void Vols(const double* K, const double* T, double* out, std::size_t n) const;	//hinted walk, fastest on sorted chains
+
+	//Call and put prices of a chain on one underlying, vol of every contract from the surface
+	void PriceChain(double S, double r, const double* K, const double* T, double* call, double* put, std::size_t n) const;
+};
+
+#endif
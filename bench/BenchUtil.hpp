@@ -0,0 +1,85 @@
+//Small dependency-free timing helpers shared by the benchmark/harness programs in this folder
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#ifndef Bench_Util_HPP
+#define Bench_Util_HPP
+
+namespace Bench {
+
+	inline volatile double sink = 0;					//results are accumulated here so the optimizer can't drop the work
+
+	template<typename F>
+	double ns_per_op(F&& body, std::size_t ops, int reps = 5)	//run body() reps times, return the best time per op in ns
+	{
+		double best = 1e300;
+
+		for (int i = 0; i < reps; i++)
+		{
+			auto t0 = std::chrono::steady_clock::now();
+			body();
+			auto t1 = std::chrono::steady_clock::now();
+
+			double ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / ops;
+			if (ns < best)
+				best = ns;
+		}
+
+		return best;
+	}
+
+	struct Result											//one measured case of a suite
+	{
+		std::string name;									//"group/case", e.g. "cdf/N"
+		double ns_per_op;
+		std::size_t ops;									//operations per repetition
+		std::string unit;									//what one op is ("call", "contract", "line" ...)
+	};
+
+	class Suite												//collects results and prints them as a table or JSON
+	{
+	private:
+		std::vector<Result> results;
+		std::string filter_val;
+
+	public:
+		explicit Suite(const std::string& filter = "") : filter_val(filter) {}
+
+		bool enabled(const std::string& name) const			//cases not matching the filter are skipped
+		{
+			return filter_val.empty() || name.find(filter_val) != std::string::npos;
+		}
+
+		template<typename F>
+		void run(const std::string& name, const std::string& unit, std::size_t ops, F&& body, int reps = 5)
+		{
+			if (!enabled(name))
+				return;
+
+			Result r = { name, ns_per_op(body, ops, reps), ops, unit };
+			results.push_back(r);
+			std::fprintf(stderr, "%-36s %12.2f ns/%-9s %14.0f %s/s\n", name.c_str(), r.ns_per_op, unit.c_str(),
+						 1e9 / r.ns_per_op, unit.c_str());
+		}
+
+		void write_json(std::FILE* f) const					//{"benchmarks": [{"name", "ns_per_op", "ops_per_sec", "unit", "ops"}, ...]}
+		{
+			std::fprintf(f, "{\n  \"benchmarks\": [\n");
+			for (std::size_t i = 0; i < results.size(); i++)
+			{
+				const Result& r = results[i];
+				std::fprintf(f, "    {\"name\": \"%s\", \"ns_per_op\": %.4f, \"ops_per_sec\": %.1f, \"unit\": \"%s\", \"ops\": %zu}%s\n",
+							 r.name.c_str(), r.ns_per_op, 1e9 / r.ns_per_op, r.unit.c_str(), r.ops,
+							 (i + 1 < results.size()) ? "," : "");
+			}
+			std::fprintf(f, "  ]\n}\n");
+		}
+	};
+
+}
+
+#endif
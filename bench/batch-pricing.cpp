@@ -0,0 +1,96 @@
+// Throughput and agreement check of BatchPricing against the scalar EuropeanOption path, and of the
+// single precision batch path against the double one (the numbers published in BatchPricing.hpp)
+//
+// Build: g++ -O2 -std=c++17 bench/batch-pricing.cpp BatchPricing.cpp EuropeanOption.cpp ImpliedVolatility.cpp OptionProbability.cpp OptionProbabilitySimd.cpp -o batch-pricing
+
+#include "../BatchPricing.hpp"
+#include "../EuropeanOption.hpp"
+#include "BenchUtil.hpp"
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+int main()
+{
+	const std::size_t n = 1000000;
+
+	std::mt19937_64 gen(42);
+	std::uniform_real_distribution<double> uS(50, 150), uK(50, 150), uT(0.01, 3), ur(0, 0.1), uv(0.05, 0.8);
+
+	BatchPricing::EuropeanBatch batch;
+	batch.reserve(n);
+	for (std::size_t i = 0; i < n; i++)
+		batch.add(uS(gen), uK(gen), uT(gen), ur(gen), uv(gen), (i % 2) ? 'P' : 'C');
+
+	std::vector<double> prices(n), call(n), put(n), scalar_call(n), scalar_put(n);
+
+	EuropeanOption opt;
+	double ns_scalar = Bench::ns_per_op([&] {
+		for (std::size_t i = 0; i < n; i++)
+		{
+			opt.SetValues({ batch.S[i], batch.K[i], batch.T[i], batch.r[i], batch.vol[i] });
+			scalar_call[i] = opt.Call();
+			scalar_put[i] = opt.Put();
+		}
+	}, n, 3);
+
+	double ns_prices = Bench::ns_per_op([&] { batch.Prices(prices.data()); }, n);
+	double ns_callput = Bench::ns_per_op([&] { batch.CallPut(call.data(), put.data()); }, n);
+
+	double max_err = 0;
+	for (std::size_t i = 0; i < n; i++)
+	{
+		double scale = batch.S[i] + batch.K[i];
+		double typed = (batch.type[i] == 'C') ? scalar_call[i] : scalar_put[i];
+		max_err = std::fmax(max_err, std::fabs(prices[i] - typed) / scale);
+		max_err = std::fmax(max_err, std::fabs(call[i] - scalar_call[i]) / scale);
+		max_err = std::fmax(max_err, std::fabs(put[i] - scalar_put[i]) / scale);
+	}
+
+	std::printf("%zu contracts\n", n);
+	std::printf("scalar Call()+Put()      %8.2f ns/contract  %7.2f M contracts/s\n", ns_scalar, 1e3 / ns_scalar);
+	std::printf("BatchPricing::Prices     %8.2f ns/contract  %7.2f M contracts/s\n", ns_prices, 1e3 / ns_prices);
+	std::printf("BatchPricing::CallPut    %8.2f ns/contract  %7.2f M contracts/s\n", ns_callput, 1e3 / ns_callput);
+	std::printf("max |batch - scalar| / (S + K) = %.3e (tolerance %.0e) %s\n",
+				max_err, BatchPricing::tolerance, max_err <= BatchPricing::tolerance ? "OK" : "FAIL");
+
+	//Single precision batch against the double one
+	std::vector<float> fS(n), fK(n), fT(n), fr(n), fvol(n), fcall(n), fput(n);
+	for (std::size_t i = 0; i < n; i++)
+	{
+		fS[i] = (float)batch.S[i];
+		fK[i] = (float)batch.K[i];
+		fT[i] = (float)batch.T[i];
+		fr[i] = (float)batch.r[i];
+		fvol[i] = (float)batch.vol[i];
+	}
+
+	double ns_float = Bench::ns_per_op([&] {
+		BatchPricing::CallPut(fS.data(), fK.data(), fT.data(), fr.data(), fvol.data(), fcall.data(), fput.data(), n);
+	}, n);
+
+	double max_abs = 0, max_scaled = 0, max_rel = 0;
+	for (std::size_t i = 0; i < n; i++)
+	{
+		double scale = batch.S[i] + batch.K[i];
+		const double v[2] = { call[i], put[i] };
+		const double f[2] = { fcall[i], fput[i] };
+		for (int j = 0; j < 2; j++)
+		{
+			double e = std::fabs(f[j] - v[j]);
+			max_abs = std::fmax(max_abs, e);
+			max_scaled = std::fmax(max_scaled, e / scale);
+			if (v[j] >= BatchPricing::float_relative_floor * scale)
+				max_rel = std::fmax(max_rel, e / v[j]);
+		}
+	}
+	bool float_ok = max_scaled <= BatchPricing::float_tolerance && max_rel <= BatchPricing::float_relative_tolerance;
+
+	std::printf("BatchPricing::CallPut(float) %4.2f ns/contract  %7.2f M contracts/s\n", ns_float, 1e3 / ns_float);
+	std::printf("float vs double: max abs %.3e, max abs / (S + K) %.3e (tolerance %.0e), "
+				"max rel %.3e for prices >= %.0e (S + K) (tolerance %.0e) %s\n",
+				max_abs, max_scaled, BatchPricing::float_tolerance, max_rel, BatchPricing::float_relative_floor,
+				BatchPricing::float_relative_tolerance, float_ok ? "OK" : "FAIL");
+
+	return max_err <= BatchPricing::tolerance && float_ok ? 0 : 1;
+}
@@ -0,0 +1,430 @@
+// Micro and macro benchmark suite with machine-readable output
+//
+// Measures ns/op of the normal CDF, single prices and greeks, batch pricing, matrix_eval,
+// implied vol, vol surface lookups, option book spot ticks, finite difference and lattice
+// americans, Monte Carlo Asians, the scenario risk ladder and end-to-end text file throughput
+// (lines/s) on generated inputs. The table goes to stderr, JSON to stdout or to a file, so two
+// commits can be compared by diffing the JSON.
+//
+// Build: g++ -O2 -std=c++17 -pthread bench/benchmark-suite.cpp $(ls *.cpp | grep -v option-calculator) -o benchmark-suite
+// Usage: benchmark-suite [--json results.json] [--filter name-part] [--quick]
+
+#include "../AmericanOption.hpp"
+#include "../BatchFile.hpp"
+#include "../BatchPricing.hpp"
+#include "../EuropeanOption.hpp"
+#include "../ImpliedVolatility.hpp"
+#include "../LatticeOption.hpp"
+#include "../MonteCarlo.hpp"
+#include "../OptionBook.hpp"
+#include "../OptionProbability.hpp"
+#include "../PerpetualAmericanOption.hpp"
+#include "../PerpetualBatch.hpp"
+#include "../ScenarioEngine.hpp"
+#include "../StaticOption.hpp"
+#include "../VolSurface.hpp"
+#include "BenchUtil.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <ostream>
+#include <random>
+#include <streambuf>
+#include <string>
+
+namespace {
+
+	class NullBuffer : public std::streambuf						//discards everything, used as the file mode output
+	{
+	protected:
+		std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+		int overflow(int c) override { return c; }
+	};
+
+	struct Inputs													//generated contracts, SoA
+	{
+		std::vector<double> S, K, T, r, vol;
+		std::vector<char> type;
+
+		explicit Inputs(std::size_t n)
+		{
+			std::mt19937_64 gen(2024);
+			std::uniform_real_distribution<double> uS(50, 150), uK(50, 150), uT(0.02, 3), ur(0, 0.1), uv(0.05, 0.8);
+			for (std::size_t i = 0; i < n; i++)
+			{
+				S.push_back(uS(gen));
+				K.push_back(uK(gen));
+				T.push_back(uT(gen));
+				r.push_back(ur(gen));
+				vol.push_back(uv(gen));
+				type.push_back((i % 2) ? 'P' : 'C');
+			}
+		}
+
+		std::size_t size() const { return S.size(); }
+	};
+
+}
+
+int main(int argc, char* argv[])
+{
+	const char* json_path = nullptr;
+	std::string filter;
+	bool quick = false;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "--json") && i + 1 < argc)
+			json_path = argv[++i];
+		else if (!strcmp(argv[i], "--filter") && i + 1 < argc)
+			filter = argv[++i];
+		else if (!strcmp(argv[i], "--quick"))
+			quick = true;
+	}
+
+	const std::size_t n = quick ? 20000 : 200000;					//contracts per micro benchmark
+	const std::size_t file_lines = quick ? 50000 : 1000000;		//lines of the generated text file
+	const int reps = quick ? 2 : 5;
+
+	Inputs in(n);
+	std::vector<double> out_static(n);
+	Bench::Suite suite(filter);
+	double acc = 0;
+
+	//Normal CDF/PDF
+	suite.run("cdf/N", "call", n, [&] {
+		for (std::size_t i = 0; i < n; i++)
+			acc += OptionProbability::N(in.vol[i] * 8 - 3);
+	}, reps);
+	suite.run("cdf/n", "call", n, [&] {
+		for (std::size_t i = 0; i < n; i++)
+			acc += OptionProbability::n(in.vol[i] * 8 - 3);
+	}, reps);
+	{
+		std::vector<double> xs(n), ys(n);
+		for (std::size_t i = 0; i < n; i++)
+			xs[i] = in.vol[i] * 8 - 3;
+		suite.run(std::string("cdf/N(array, ") + OptionProbability::simd_name(OptionProbability::simd_level()) + ")", "value", n, [&] {
+			OptionProbability::N(xs.data(), ys.data(), n);
+			acc += ys[n / 2];
+		}, reps);
+		suite.run(std::string("cdf/n(array, ") + OptionProbability::simd_name(OptionProbability::simd_level()) + ")", "value", n, [&] {
+			OptionProbability::n(xs.data(), ys.data(), n);
+			acc += ys[n / 2];
+		}, reps);
+	}
+	suite.run("cdf/table_cdf", "call", n, [&] {
+		for (std::size_t i = 0; i < n; i++)
+			acc += OptionProbability::table_cdf(in.vol[i] * 8 - 3);
+	}, reps);
+	suite.run("cdf/simpson_cdf", "call", n / 100, [&] {
+		for (std::size_t i = 0; i < n / 100; i++)
+			acc += OptionProbability::simpson_cdf(in.vol[i] * 8 - 3);
+	}, reps);
+
+	//Single contracts through EuropeanOption
+	std::vector<EuropeanOption> opts(n);
+	for (std::size_t i = 0; i < n; i++)
+	{
+		opts[i].SetValues({ in.S[i], in.K[i], in.T[i], in.r[i], in.vol[i] });
+		if (in.type[i] != opts[i].type())
+			opts[i].toggle();
+	}
+
+	suite.run("price/EuropeanOption::Call", "contract", n, [&] {
+		for (const EuropeanOption& o : opts)
+			acc += o.Call();
+	}, reps);
+	suite.run("price/EuropeanOption::Price", "contract", n, [&] {
+		for (std::size_t i = 0; i < n; i++)							//through the virtual interface
+			acc += static_cast<const Option&>(opts[i]).Price();
+	}, reps);
+
+	PerpetualAmericanOption perp;
+	perp.SetValues({ 110, 100, 0.1, 0.02, 0.1 });
+	suite.run("price/PerpetualAmericanOption::Call", "contract", n, [&] {
+		for (std::size_t i = 0; i < n; i++)
+		{
+			perp.S(in.S[i]);
+			acc += perp.Call();
+		}
+	}, reps);
+
+	std::vector<double> perp_r(n), perp_b(n, 0.02), perp_vol(n), perp_call(n), perp_put(n);
+	for (std::size_t i = 0; i < n; i++)							//groups of 1000 contracts sharing (r, b, vol)
+	{
+		perp_r[i] = 0.05 + 0.001 * (i / 1000 % 5);
+		perp_vol[i] = 0.1 + 0.01 * (i / 1000 % 20);
+	}
+	suite.run("price/PerpetualBatch::CallPut", "contract", n, [&] {
+		PerpetualBatch::CallPut(in.S.data(), in.K.data(), perp_r.data(), perp_b.data(), perp_vol.data(),
+								perp_call.data(), perp_put.data(), n);
+		acc += perp_call[0];
+	}, reps);
+	{
+		std::vector<double> mixed_r(n), mixed_vol(n);			//the same 100 keys, interleaved row by row
+		for (std::size_t i = 0; i < n; i++)
+		{
+			mixed_r[i] = 0.05 + 0.001 * (i % 5);
+			mixed_vol[i] = 0.1 + 0.01 * (i / 5 % 20);
+		}
+		suite.run("price/PerpetualBatch::CallPut(interleaved)", "contract", n, [&] {
+			PerpetualBatch::CallPut(in.S.data(), in.K.data(), mixed_r.data(), perp_b.data(), mixed_vol.data(),
+									perp_call.data(), perp_put.data(), n);
+			acc += perp_call[0];
+		}, reps);
+	}
+
+	//Static dispatch over the same contracts (all calls, compare with the virtual loop below)
+	std::vector<EuropeanModel> models;
+	for (const EuropeanOption& o : opts)
+		models.emplace_back(o);
+	std::vector<EuropeanOption> calls(opts);
+	for (EuropeanOption& o : calls)
+		if (o.type() != 'C')
+			o.toggle();
+
+	suite.run("static/Option::Price(virtual,calls)", "contract", n, [&] {
+		for (const EuropeanOption& o : calls)
+			acc += static_cast<const Option&>(o).Price();
+	}, reps);
+	suite.run("static/PriceAll<'C'>(EuropeanModel)", "contract", n, [&] {
+		PriceAll<'C'>(models.data(), out_static.data(), n);
+		acc += out_static[0];
+	}, reps);
+
+	//Greeks
+	suite.run("greeks/Delta+Gamma", "contract", n, [&] {
+		for (const EuropeanOption& o : opts)
+			acc += o.Delta() + o.Gamma();
+	}, reps);
+	suite.run("greeks/Evaluate", "contract", n, [&] {
+		for (const EuropeanOption& o : opts)
+			acc += o.Evaluate().gamma;
+	}, reps);
+	suite.run("greeks/approximated_Gamma(AD)", "contract", n, [&] {
+		for (const EuropeanOption& o : opts)
+			acc += o.approximated_Gamma();
+	}, reps);
+
+	//Batch paths
+	std::vector<double> out1(n), out2(n);
+	suite.run("batch/BatchPricing::Prices", "contract", n, [&] {
+		BatchPricing::Prices(in.S.data(), in.K.data(), in.T.data(), in.r.data(), in.vol.data(), in.type.data(),
+							 out1.data(), n);
+	}, reps);
+	suite.run("batch/BatchPricing::CallPut", "contract", n, [&] {
+		BatchPricing::CallPut(in.S.data(), in.K.data(), in.T.data(), in.r.data(), in.vol.data(),
+							  out1.data(), out2.data(), n);
+	}, reps);
+	if (suite.enabled("batch/BatchPricing::CallPut(float)"))
+	{
+		std::vector<float> fS(in.S.begin(), in.S.end()), fK(in.K.begin(), in.K.end()), fT(in.T.begin(), in.T.end());
+		std::vector<float> fr(in.r.begin(), in.r.end()), fvol(in.vol.begin(), in.vol.end()), fcall(n), fput(n);
+		suite.run("batch/BatchPricing::CallPut(float)", "contract", n, [&] {
+			BatchPricing::CallPut(fS.data(), fK.data(), fT.data(), fr.data(), fvol.data(), fcall.data(), fput.data(), n);
+			acc += fcall[n / 2];
+		}, reps);
+	}
+
+	std::vector<std::vector<double>> greek_cols(10, std::vector<double>(n));
+	BatchPricing::GreekColumns g = { greek_cols[0].data(), greek_cols[1].data(), greek_cols[2].data(), greek_cols[3].data(),
+									 greek_cols[4].data(), greek_cols[5].data(), greek_cols[6].data(), greek_cols[7].data(),
+									 greek_cols[8].data(), greek_cols[9].data() };
+	suite.run("batch/BatchPricing::Greeks", "contract", n, [&] {
+		BatchPricing::Greeks(in.S.data(), in.K.data(), in.T.data(), in.r.data(), in.vol.data(), g, n);
+	}, reps);
+
+	std::vector<std::vector<double>> matrix = { in.S, in.K, in.T, in.r, in.vol };
+	suite.run("batch/matrix_calc(Price)", "contract", n, [&] {
+		acc += matrix_calc<EuropeanOption>(matrix, 'C', &EuropeanOption::Price)[0];
+	}, reps);
+	suite.run("batch/matrix_eval(Price,Delta,Gamma)", "contract", n, [&] {
+		acc += matrix_eval<EuropeanOption>(matrix, 'C', { &EuropeanOption::Price, &EuropeanOption::Delta,
+														  &EuropeanOption::Gamma })[0][0];
+	}, reps);
+
+	if (suite.enabled("batch/ImpliedVolatility::Solve"))
+	{
+		std::vector<double> quotes(n);								//call price on 'C' rows, put price on 'P' rows
+		std::vector<int> iterations(n);
+		BatchPricing::Prices(in.S.data(), in.K.data(), in.T.data(), in.r.data(), in.vol.data(), in.type.data(),
+							 quotes.data(), n);
+		suite.run("batch/ImpliedVolatility::Solve", "quote", n, [&] {
+			ImpliedVolatility::Solve(quotes.data(), in.S.data(), in.K.data(), in.T.data(), in.r.data(), in.type.data(),
+									 out2.data(), iterations.data(), nullptr, n);
+		}, reps);
+	}
+
+	//Spot tick on one underlying of a book vs repricing the same contracts from scratch
+	const std::size_t book_n = quick ? 2000 : 5000;
+	OptionBook book;
+	std::size_t book_u = book.AddUnderlying(100);
+	book.AddUnderlying(50);										//other underlyings are not touched by the tick
+	book.Reserve(book_u, book_n);
+	for (std::size_t i = 0; i < book_n; i++)
+		book.AddContract(book_u, in.T[i], in.K[i], in.r[i], in.vol[i]);
+	std::vector<double> spot(book_n, 100);
+
+	suite.run("book/OptionBook::Tick", "contract", book_n * 100, [&] {
+		for (int t = 0; t < 100; t++)
+			book.Tick(book_u, 100 + t * 0.01);
+		acc += book.Call(book_u, 0);
+	}, reps);
+	suite.run("book/BatchPricing::Greeks(same contracts)", "contract", book_n * 100, [&] {
+		for (int t = 0; t < 100; t++)
+		{
+			std::fill(spot.begin(), spot.end(), 100 + t * 0.01);
+			BatchPricing::Greeks(spot.data(), in.K.data(), in.T.data(), in.r.data(), in.vol.data(), g, book_n);
+		}
+		acc += g.call[0];
+	}, reps);
+
+	//Finite difference american options on the default 200 x 100 grid
+	const std::size_t fd_n = quick ? 50 : 500;
+	std::vector<AmericanOption> american(fd_n);
+	for (std::size_t i = 0; i < fd_n; i++)
+	{
+		american[i].SetValues({ in.S[i], in.K[i], in.T[i], in.r[i], in.vol[i], 0.02 });
+		if (in.type[i] != american[i].type())
+			american[i].toggle();
+	}
+	suite.run("fd/AmericanOption::SolveMany(1 thread)", "contract", fd_n, [&] {
+		AmericanOption::SolveMany(american.data(), out1.data(), fd_n, 1);
+		acc += out1[0];
+	}, reps);
+	suite.run("fd/AmericanOption::SolveMany(all threads)", "contract", fd_n, [&] {
+		AmericanOption::SolveMany(american.data(), out1.data(), fd_n, 0);
+		acc += out1[0];
+	}, reps);
+
+	//Lattice americans on the same contracts, binomial 200 steps + Richardson
+	std::vector<LatticeOption> lattice(fd_n);
+	LatticeSettings lattice_settings;
+	lattice_settings.steps = 200;
+	lattice_settings.richardson = true;
+	for (std::size_t i = 0; i < fd_n; i++)
+	{
+		lattice[i].SetValues({ in.S[i], in.K[i], in.T[i], in.r[i], in.vol[i], 0.02 });
+		lattice[i].settings(lattice_settings);
+		if (in.type[i] != lattice[i].type())
+			lattice[i].toggle();
+	}
+	suite.run("fd/LatticeOption::SolveMany(1 thread)", "contract", fd_n, [&] {
+		LatticeOption::SolveMany(lattice.data(), out1.data(), fd_n, 1);
+		acc += out1[0];
+	}, reps);
+
+	//Monte Carlo, 12 date arithmetic Asian, antithetic + control variate (an op is one path)
+	MonteCarlo::Contract asian;
+	MonteCarlo::Settings mc;
+	mc.paths = quick ? 20000 : 200000;
+	suite.run("mc/Asian(philox,1 thread)", "path", mc.paths, [&] {
+		acc += MonteCarlo::Price(asian, mc).price;
+	}, reps);
+	mc.sobol = true;
+	suite.run("mc/Asian(sobol,1 thread)", "path", mc.paths, [&] {
+		acc += MonteCarlo::Price(asian, mc).price;
+	}, reps);
+	mc.sobol = false;
+	mc.threads = 0;
+	suite.run("mc/Asian(philox,all threads)", "path", mc.paths, [&] {
+		acc += MonteCarlo::Price(asian, mc).price;
+	}, reps);
+
+	//5000 strike chain priced from a 60 strike x 12 expiry surface
+	{
+		std::vector<double> grid_K, grid_T, grid_vol;
+		for (int i = 0; i < 60; i++)
+			grid_K.push_back(40 + 2.0 * i);
+		for (int j = 0; j < 12; j++)
+			grid_T.push_back(0.1 + 0.25 * j);
+		for (int j = 0; j < 12; j++)
+			for (int i = 0; i < 60; i++)
+				grid_vol.push_back(0.2 + 0.1 * std::fabs(std::log(grid_K[i] / 100)) + 0.01 * j);
+
+		VolSurface surface;
+		surface.Set(grid_K, grid_T, grid_vol);
+
+		const std::size_t chain = 5000;
+		std::vector<double> chain_K(chain), chain_T(chain, 0.5);
+		for (std::size_t i = 0; i < chain; i++)
+			chain_K[i] = 40 + 0.024 * i;
+
+		suite.run("vol/VolSurface::Vols(sorted chain)", "contract", chain, [&] {
+			surface.Vols(chain_K.data(), chain_T.data(), out1.data(), chain);
+			acc += out1[0];
+		}, reps);
+		suite.run("vol/VolSurface::PriceChain", "contract", chain, [&] {
+			surface.PriceChain(100, 0.05, chain_K.data(), chain_T.data(), out1.data(), out2.data(), chain);
+			acc += out1[0];
+		}, reps);
+	}
+
+	//Risk ladder, 100k positions x 50 spot x 50 vol shocks (an op is one position in one scenario)
+	if (suite.enabled("scenario/"))
+	{
+		const std::size_t positions = quick ? 10000 : 100000;
+		const std::size_t axis = quick ? 10 : 50;
+		std::vector<double> quantities(positions);
+		std::vector<double> spot_shocks, vol_shocks;
+		for (std::size_t i = 0; i < positions; i++)
+			quantities[i] = (i % 3) ? 10.0 : -5.0;
+		for (std::size_t i = 0; i < axis; i++)
+		{
+			spot_shocks.push_back(-0.25 + 0.5 * i / (axis - 1));
+			vol_shocks.push_back(-0.1 + 0.2 * i / (axis - 1));
+		}
+
+		suite.run("scenario/ScenarioEngine::Run(1 thread)", "point", positions * axis * axis, [&] {
+			acc += ScenarioEngine::Run(opts.data(), quantities.data(), positions, spot_shocks, vol_shocks, 1).pnl[0];
+		}, 1);
+		suite.run("scenario/ScenarioEngine::Run(all threads)", "point", positions * axis * axis, [&] {
+			acc += ScenarioEngine::Run(opts.data(), quantities.data(), positions, spot_shocks, vol_shocks, 0).pnl[0];
+		}, 1);
+	}
+
+	//End-to-end text file mode (parse, price, format) on a generated file held in memory
+	if (suite.enabled("file/"))
+	{
+		std::string text;
+		char line[128];
+		for (std::size_t i = 0; i < file_lines; i++)
+		{
+			std::size_t j = i % n;
+			std::snprintf(line, sizeof(line), "%.4f %.2f %.3f %.3f %.2f\n", in.T[j], in.K[j], in.vol[j], in.r[j], in.S[j]);
+			text += line;
+		}
+
+		NullBuffer null_buf;
+		std::ostream null_out(&null_buf);
+		BatchFileOptions options;
+
+		suite.run("file/PriceTextFile(1 thread)", "line", file_lines, [&] {
+			PriceTextFile(text.data(), text.size(), null_out, null_out, options);
+		}, reps > 3 ? 3 : reps);
+
+		options.threads = 0;
+		suite.run("file/PriceTextFile(all threads)", "line", file_lines, [&] {
+			PriceTextFile(text.data(), text.size(), null_out, null_out, options);
+		}, reps > 3 ? 3 : reps);
+	}
+
+	Bench::sink = Bench::sink + acc;
+
+	if (json_path)
+	{
+		std::FILE* f = std::fopen(json_path, "w");
+		if (!f)
+		{
+			std::fprintf(stderr, "Error opening file: %s\n", json_path);
+			return 1;
+		}
+		suite.write_json(f);
+		std::fclose(f);
+	}
+	else
+		suite.write_json(stdout);
+
+	return 0;
+}
@@ -0,0 +1,272 @@
+// Accuracy and speed harness for the standard normal CDF/PDF backends in OptionProbability
+// Every backend is compared against a long double erfc reference over [-10, 10], the array kernels
+// (scalar, AVX2, AVX-512 as supported) are also checked over [-37, 37]: absolute CDF error, ulps of the
+// PDF and agreement of the SIMD kernels with the AVX2 one in ulps. The relative error of the tail
+// N(-|x|) is printed for information only. The single precision kernels are checked on [-13, 13].
+// The lookup table CDF/PDF is checked on a grid of [-40, 40] that falls between the table nodes, plus
+// the nodes, interval midpoints, infinities and NaN.
+//
+// Build: g++ -O2 -std=c++17 bench/cdf-accuracy.cpp OptionProbability.cpp OptionProbabilitySimd.cpp OptionProbabilityTable.cpp -o cdf-accuracy
+
+#include "../OptionProbability.hpp"
+#include "BenchUtil.hpp"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+static long double ref_N(long double x) { return 0.5L * erfcl(-x / sqrtl(2.0L)); }
+static long double ref_n(long double x) { return expl(-x * x / 2) / sqrtl(2 * 3.141592653589793238462643383279502884L); }
+
+static void report(const char* name, double (*f)(double), long double (*ref)(long double),
+				   const std::vector<double>& xs, int reps)
+{
+	double max_abs = 0;
+	double max_rel = 0;
+	double worst_x = 0;
+
+	for (double x : xs)
+	{
+		long double r = ref(x);
+		double abs_err = (double)fabsl(f(x) - r);
+		double rel_err = r != 0 ? (double)(abs_err / fabsl(r)) : 0;
+
+		if (abs_err > max_abs)
+		{
+			max_abs = abs_err;
+			worst_x = x;
+		}
+		if (rel_err > max_rel)
+			max_rel = rel_err;
+	}
+
+	double ns = Bench::ns_per_op([&] {
+		double acc = 0;
+		for (double x : xs)
+			acc += f(x);
+		Bench::sink = Bench::sink + acc;
+	}, xs.size(), reps);
+
+	std::printf("%-14s max abs err %.3e (at x = %+.3f)  max rel err %.3e  %9.2f ns/call\n",
+				name, max_abs, worst_x, max_rel, ns);
+}
+
+static double ulps(double v, long double ref)					//error in units of the last place of the reference
+{
+	double r = (double)ref;
+	double ulp = std::nextafter(std::fabs(r), INFINITY) - std::fabs(r);
+	return (double)(fabsl(v - ref) / ulp);
+}
+
+static bool report_arrays(const std::vector<double>& xs, int reps)	//returns false if a kernel breaks the documented bounds
+{
+	const double agree_bound = 16;								//documented in OptionProbability.hpp
+	const double abs_bound = 3e-16;
+	const double pdf_bound = 4;
+	std::size_t n = xs.size();
+	std::vector<double> lower(n), upper(n), pdf(n), base_lower(n), base_pdf(n);
+	bool ok = true;
+
+	OptionProbability::Simd best = OptionProbability::simd_supported();
+	for (int level = 0; level <= (int)best; level++)
+	{
+		OptionProbability::simd_level((OptionProbability::Simd)level);
+		OptionProbability::N_pair(xs.data(), lower.data(), upper.data(), n);
+		OptionProbability::n(xs.data(), pdf.data(), n);
+		if (level == 1)											//the SIMD kernels share their formulas, the scalar CDF doesn't
+		{
+			base_lower = lower;
+			base_pdf = pdf;
+		}
+
+		double worst_abs = 0, worst_tail = 0, worst_x = 0, worst_pdf = 0, worst_agree = 0;
+		for (std::size_t i = 0; i < n; i++)
+		{
+			worst_abs = std::max(worst_abs, (double)fabsl(lower[i] - ref_N(xs[i])));
+
+			long double t = ref_N(-fabsl(xs[i]));
+			double tail = xs[i] < 0 ? lower[i] : upper[i];
+			if (t >= (long double)DBL_MIN)
+			{
+				double e = ulps(tail, t);
+				if (e > worst_tail)
+				{
+					worst_tail = e;
+					worst_x = xs[i];
+				}
+			}
+			long double p = ref_n(xs[i]);
+			if (p >= (long double)DBL_MIN)
+				worst_pdf = std::max(worst_pdf, ulps(pdf[i], p));
+
+			if (level == 0)
+				continue;
+			if (base_lower[i] >= DBL_MIN)
+				worst_agree = std::max(worst_agree, ulps(lower[i], base_lower[i]));
+			if (base_pdf[i] >= DBL_MIN)
+				worst_agree = std::max(worst_agree, ulps(pdf[i], base_pdf[i]));
+		}
+
+		double ns_N = Bench::ns_per_op([&] { OptionProbability::N(xs.data(), lower.data(), n); }, n, reps);
+		double ns_n = Bench::ns_per_op([&] { OptionProbability::n(xs.data(), pdf.data(), n); }, n, reps);
+
+		char agree[32] = "   -";
+		if (level > 0)
+			std::snprintf(agree, sizeof(agree), "%.2f", worst_agree);
+		std::printf("%-8s N abs err %.2e  tail rel %.2e (at x = %+.3f)  pdf %.2f ulp  vs avx2 %s ulp  "
+					"N %6.2f ns/value  n %6.2f ns/value\n",
+					OptionProbability::simd_name((OptionProbability::Simd)level), worst_abs, worst_tail * DBL_EPSILON,
+					worst_x, worst_pdf, agree, ns_N, ns_n);
+
+		if (worst_abs > abs_bound || worst_pdf > pdf_bound || worst_agree > agree_bound)
+			ok = false;
+	}
+
+	OptionProbability::simd_level(best);
+	return ok;
+}
+
+static double ulps_float(float v, long double ref)
+{
+	float r = (float)ref;
+	float ulp = std::nextafter(std::fabs(r), INFINITY) - std::fabs(r);
+	return (double)(fabsl(v - ref) / ulp);
+}
+
+static bool report_float_arrays(const std::vector<double>& wide, int reps)	//single precision kernels on [-13, 13]
+{
+	const double abs_bound = 1.5e-7;							//documented in OptionProbability.hpp
+	const double pdf_bound = 4;
+	std::vector<float> xs;
+	for (double x : wide)
+		if (std::fabs(x) <= 13)
+			xs.push_back((float)x);
+	std::size_t n = xs.size();
+	std::vector<float> lower(n), upper(n), pdf(n);
+	bool ok = true;
+
+	OptionProbability::Simd best = OptionProbability::simd_supported();
+	for (int level = 0; level <= (int)best; level++)
+	{
+		OptionProbability::simd_level((OptionProbability::Simd)level);
+		OptionProbability::N_pair(xs.data(), lower.data(), upper.data(), n);
+		OptionProbability::n(xs.data(), pdf.data(), n);
+
+		double worst_abs = 0, worst_pdf = 0;
+		for (std::size_t i = 0; i < n; i++)
+		{
+			worst_abs = std::max(worst_abs, (double)fabsl(lower[i] - ref_N(xs[i])));
+			long double p = ref_n(xs[i]);
+			if (p >= (long double)FLT_MIN)
+				worst_pdf = std::max(worst_pdf, ulps_float(pdf[i], p));
+		}
+
+		double ns_N = Bench::ns_per_op([&] { OptionProbability::N(xs.data(), lower.data(), n); }, n, reps);
+		double ns_n = Bench::ns_per_op([&] { OptionProbability::n(xs.data(), pdf.data(), n); }, n, reps);
+
+		std::printf("%-8s N abs err %.2e  pdf %.2f ulp  N %6.2f ns/value  n %6.2f ns/value\n",
+					OptionProbability::simd_name((OptionProbability::Simd)level), worst_abs, worst_pdf, ns_N, ns_n);
+
+		if (worst_abs > abs_bound || worst_pdf > pdf_bound)
+			ok = false;
+	}
+
+	OptionProbability::simd_level(best);
+	return ok;
+}
+
+static bool report_table(int reps)							//table_cdf / table_pdf against their bounds
+{
+	const double abs_bound = 5e-14;								//documented in OptionProbability.hpp
+	const double tail_bound = 7e-9;
+	const double pdf_abs_bound = 1.5e-13;
+	const double pdf_rel_bound = 7e-9;
+	std::vector<double> xs;
+	for (long i = -4000000; i <= 4000000; i++)					//step 1e-5 never lands on a node (multiples of 1/32)
+		xs.push_back(i * 1e-5 + 3e-6);
+	for (int i = -272 * 2; i <= 272 * 2; i++)					//nodes and midpoints of the table
+		xs.push_back(i / 64.0);
+
+	double worst_abs = 0, worst_tail = 0, worst_tail_x = 0, worst_pdf_abs = 0, worst_pdf_rel = 0;
+	for (double x : xs)
+	{
+		worst_abs = std::max(worst_abs, (double)fabsl(OptionProbability::table_cdf(x) - ref_N(x)));
+
+		long double t = ref_N(-fabsl(x));
+		double tail = OptionProbability::table_cdf(-std::fabs(x));
+		if (t >= (long double)DBL_MIN && std::fabs(x) <= 37)	//0 beyond 37, see OptionProbabilityTable.cpp
+		{
+			double e = (double)(fabsl(tail - t) / t);
+			if (e > worst_tail)
+			{
+				worst_tail = e;
+				worst_tail_x = x;
+			}
+		}
+
+		long double p = ref_n(x);
+		double pdf = OptionProbability::table_pdf(x);
+		worst_pdf_abs = std::max(worst_pdf_abs, (double)fabsl(pdf - p));
+		if (p >= (long double)DBL_MIN)
+			worst_pdf_rel = std::max(worst_pdf_rel, (double)(fabsl(pdf - p) / p));
+	}
+
+	double inf = INFINITY;
+	bool special = OptionProbability::table_cdf(-inf) == 0 && OptionProbability::table_cdf(inf) == 1 &&
+				   OptionProbability::table_pdf(inf) == 0 && std::isnan(OptionProbability::table_cdf(NAN)) &&
+				   std::isnan(OptionProbability::table_pdf(NAN));
+
+	std::vector<double> sample(xs.begin() + 3000000, xs.begin() + 5000000);	//[-10, 10] for the timing
+	double ns_N = Bench::ns_per_op([&] {
+		double acc = 0;
+		for (double x : sample)
+			acc += OptionProbability::table_cdf(x);
+		Bench::sink = Bench::sink + acc;
+	}, sample.size(), reps);
+
+	std::printf("table    N abs err %.2e  tail rel %.2e (at x = %+.3f)  pdf abs %.2e rel %.2e  inf/NaN %s  "
+				"N %6.2f ns/call\n", worst_abs, worst_tail, worst_tail_x, worst_pdf_abs, worst_pdf_rel,
+				special ? "ok" : "wrong", ns_N);
+
+	return worst_abs <= abs_bound && worst_tail <= tail_bound && worst_pdf_abs <= pdf_abs_bound &&
+		   worst_pdf_rel <= pdf_rel_bound && special;
+}
+
+int main()
+{
+	std::vector<double> xs;
+	for (int i = -10000; i <= 10000; i++)
+		xs.push_back(i * 0.001);
+
+	std::printf("Standard normal CDF, %zu points on [-10, 10]\n", xs.size());
+	report("simpson_cdf", &OptionProbability::simpson_cdf, &ref_N, xs, 1);
+	report("erfc_cdf", &OptionProbability::erfc_cdf, &ref_N, xs, 5);
+	report("table_cdf", &OptionProbability::table_cdf, &ref_N, xs, 5);
+	report("N (selected)", static_cast<double (*)(double)>(&OptionProbability::N), &ref_N, xs, 5);
+
+	std::printf("\nStandard normal PDF\n");
+	report("n", static_cast<double (*)(double)>(&OptionProbability::n), &ref_n, xs, 5);
+	report("table_pdf", &OptionProbability::table_pdf, &ref_n, xs, 5);
+
+	std::vector<double> wide;
+	for (int i = -370000; i <= 370000; i++)
+		wide.push_back(i * 0.0001);
+
+	std::printf("\nArray kernels, %zu points on [-37, 37]\n", wide.size());
+	bool ok = report_arrays(wide, 5);
+
+	std::printf("\nSingle precision array kernels on [-13, 13]\n");
+	ok = report_float_arrays(wide, 5) && ok;
+
+	std::printf("\nLookup table on [-40, 40]\n");
+	ok = report_table(5) && ok;
+
+	if (!ok)
+	{
+		std::printf("FAILED: a kernel exceeds the documented bounds\n");
+		return 1;
+	}
+
+	return 0;
+}
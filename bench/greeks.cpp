@@ -0,0 +1,70 @@
+// Fused price + greeks evaluation against calling the separate EuropeanOption methods
+//
+// Build: g++ -O2 -std=c++17 bench/greeks.cpp BatchPricing.cpp EuropeanOption.cpp ImpliedVolatility.cpp OptionProbability.cpp OptionProbabilitySimd.cpp -o greeks
+
+#include "../BatchPricing.hpp"
+#include "../EuropeanOption.hpp"
+#include "BenchUtil.hpp"
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+int main()
+{
+	const std::size_t n = 200000;
+
+	std::mt19937_64 gen(7);
+	std::uniform_real_distribution<double> uS(50, 150), uK(50, 150), uT(0.01, 3), ur(0, 0.1), uv(0.05, 0.8);
+
+	BatchPricing::EuropeanBatch batch;
+	batch.reserve(n);
+	for (std::size_t i = 0; i < n; i++)
+		batch.add(uS(gen), uK(gen), uT(gen), ur(gen), uv(gen));
+
+	std::vector<EuropeanOption> opts(n);
+	for (std::size_t i = 0; i < n; i++)
+		opts[i].SetValues({ batch.S[i], batch.K[i], batch.T[i], batch.r[i], batch.vol[i] });
+
+	double ns_separate = Bench::ns_per_op([&] {
+		double acc = 0;
+		for (const EuropeanOption& o : opts)
+			acc += o.Call() + o.Put() + o.DeltaCall() + o.DeltaPut() + o.Gamma();
+		Bench::sink = Bench::sink + acc;
+	}, n);
+
+	double max_diff = 0;
+	double ns_fused = Bench::ns_per_op([&] {
+		double acc = 0;
+		for (const EuropeanOption& o : opts)
+		{
+			BlackScholesResult g = o.Evaluate();
+			acc += g.call + g.put + g.delta_call + g.delta_put + g.gamma;
+		}
+		Bench::sink = Bench::sink + acc;
+	}, n);
+
+	std::vector<std::vector<double>> cols(10, std::vector<double>(n));
+	BatchPricing::GreekColumns out = { cols[0].data(), cols[1].data(), cols[2].data(), cols[3].data(), cols[4].data(),
+									   cols[5].data(), cols[6].data(), cols[7].data(), cols[8].data(), cols[9].data() };
+	double ns_batch = Bench::ns_per_op([&] { batch.Greeks(out); }, n);
+
+	for (std::size_t i = 0; i < n; i++)
+	{
+		const EuropeanOption& o = opts[i];
+		BlackScholesResult g = o.Evaluate();
+		double diffs[] = { g.call - o.Call(), g.put - o.Put(), g.delta_call - o.DeltaCall(),
+						   g.delta_put - o.DeltaPut(), g.gamma - o.Gamma(),
+						   out.call[i] - g.call, out.put[i] - g.put, out.gamma[i] - g.gamma,
+						   out.vega[i] - g.vega, out.theta_call[i] - g.theta_call, out.rho_put[i] - g.rho_put };
+		for (double d : diffs)
+			max_diff = std::fmax(max_diff, std::fabs(d));
+	}
+
+	std::printf("%zu contracts, price + delta + gamma for call and put\n", n);
+	std::printf("separate methods          %8.2f ns/contract\n", ns_separate);
+	std::printf("EuropeanOption::Evaluate  %8.2f ns/contract  (%.1fx, also vega/theta/rho)\n", ns_fused, ns_separate / ns_fused);
+	std::printf("BatchPricing::Greeks      %8.2f ns/contract  (%.1fx, all ten outputs)\n", ns_batch, ns_separate / ns_batch);
+	std::printf("max abs difference between paths %.3e\n", max_diff);
+
+	return 0;
+}
@@ -0,0 +1,76 @@
+// Speed and round-trip accuracy of the implied volatility solver
+// Quotes are generated from known vols with EuropeanOption and inverted back. Quotes whose time value
+// is lost to rounding (deep ITM/OTM at low vol) are reported as below intrinsic, as they should be.
+//
+// Build: g++ -O2 -std=c++17 bench/implied-vol.cpp ImpliedVolatility.cpp EuropeanOption.cpp OptionProbability.cpp -o implied-vol
+
+#include "../ImpliedVolatility.hpp"
+#include "../EuropeanOption.hpp"
+#include "BenchUtil.hpp"
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+int main()
+{
+	const std::size_t n = 200000;
+
+	std::mt19937_64 gen(3);
+	std::uniform_real_distribution<double> uS(20, 300), uT(0.02, 5), ur(0, 0.1), uv(0.03, 1.5);
+
+	std::vector<double> price(n), S(n), K(n, 100), T(n), r(n), vol(n), solved(n);
+	std::vector<char> type(n);
+	std::vector<int> iterations(n);
+	std::vector<ImpliedVolatility::Status> status(n);
+
+	EuropeanOption opt;
+	for (std::size_t i = 0; i < n; i++)
+	{
+		S[i] = uS(gen);
+		T[i] = uT(gen);
+		r[i] = ur(gen);
+		vol[i] = uv(gen);
+		type[i] = (i % 2) ? 'P' : 'C';
+		opt.SetValues({ S[i], K[i], T[i], r[i], vol[i] });
+		price[i] = (type[i] == 'C') ? opt.Call() : opt.Put();
+	}
+
+	double ns = Bench::ns_per_op([&] {
+		ImpliedVolatility::Solve(price.data(), S.data(), K.data(), T.data(), r.data(), type.data(),
+								 solved.data(), iterations.data(), status.data(), n);
+	}, n, 3);
+
+	std::size_t counts[5] = {};
+	double max_err = 0;
+	double max_price_err = 0;
+	long total_iter = 0;
+	int max_iter = 0;
+
+	for (std::size_t i = 0; i < n; i++)
+	{
+		counts[(int)status[i]]++;
+		total_iter += iterations[i];
+		if (iterations[i] > max_iter)
+			max_iter = iterations[i];
+
+		if (status[i] != ImpliedVolatility::Status::Converged)
+			continue;
+
+		opt.SetValues({ S[i], K[i], T[i], r[i], solved[i] });		//deep OTM quotes can be flat in vol, so compare prices too
+		double repriced = (type[i] == 'C') ? opt.Call() : opt.Put();
+		max_price_err = std::fmax(max_price_err, std::fabs(repriced - price[i]) / S[i]);
+		opt.vol(vol[i]);
+		if (opt.Evaluate().vega > 1e-6 * S[i])						//vol is only identifiable where the price depends on it
+			max_err = std::fmax(max_err, std::fabs(solved[i] - vol[i]));
+	}
+
+	std::printf("%zu quotes, S/K in [0.2, 3], T in [0.02, 5], vol in [0.03, 1.5]\n", n);
+	std::printf("%.1f ns/quote, %.2f iterations on average, %d at most\n", ns, (double)total_iter / n, max_iter);
+	for (int s = 0; s < 5; s++)
+		if (counts[s])
+			std::printf("  %-40s %zu\n", ImpliedVolatility::StatusText((ImpliedVolatility::Status)s), counts[s]);
+	std::printf("max |solved vol - true vol| = %.3e (where vega > 1e-6 S), max repricing error / S = %.3e\n",
+				max_err, max_price_err);
+
+	return 0;
+}
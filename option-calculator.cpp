@@ -2,21 +2,166 @@
 // This file contains the 'main' function. Program execution begins and ends there.
 
 #include "EuropeanOption.hpp"
-//#include "PerpetualAmericanOption.hpp"				//is not integrated in CLI yet
+#include "BatchFile.hpp"
+#include "MappedFile.hpp"
+#include "ColumnarFormat.hpp"
+#include "PricingServer.hpp"
+#include "PriceCache.hpp"
+#include "PerpetualAmericanOption.hpp"
+#include "InputValidation.hpp"
+#include "Stats.hpp"
+#include <chrono>
 #include <iostream>
-#include <cstdlib>										//for std::atof
-#include <fstream>										//for std::ifstream, ofstream
-#include <string>										//for std::getline
-#include <sstream>										//for std::istringstream
+#include <cerrno>
+#include <cstdlib>										//for std::atof, std::strtoll
+#include <fstream>										//for std::ofstream
+#include <memory>
+#include <string>
+#include <vector>
 
 
+static bool is_bin(const std::string& path)				//columnar files are recognized by extension
+{
+	return path.size() >= 4 && path.substr(path.size() - 4) == ".bin";
+}
+
+template<typename T>
+static bool parse_count(const char* flag, const char* text, long long lo, long long hi, T& value)	//false - not a whole number in [lo, hi]
+{
+	char* end;
+	errno = 0;
+	long long v = std::strtoll(text, &end, 10);
+	if (end == text || *end != '\0' || errno == ERANGE || v < lo || v > hi) {
+		std::cerr << flag << " takes a whole number from " << lo << " to " << hi << "." << std::endl;
+		return false;
+	}
+	value = (T)v;
+	return true;
+}
+
+struct StatsReport										//prints the --stats summary to stderr when main returns
+{
+	bool text = false;
+	bool json = false;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	~StatsReport()
+	{
+		double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		if (json)
+			Stats::PrintJson(std::cerr, wall);
+		else if (text)
+			Stats::Print(std::cerr, wall);
+	}
+};
+
+static bool check_quote(InputValidation::Status status, InputValidation::Policy policy)	//false - don't price
+{
+	if (!status)
+		return true;
+
+	if (policy == InputValidation::Policy::Clamp) {
+		std::cerr << "Invalid " << InputValidation::Describe(status) << " replaced by the default." << std::endl;
+		return true;
+	}
+
+	std::cerr << "Invalid " << InputValidation::Describe(status) << ", not priced." << std::endl;
+	return false;
+}
+
 int main(int argc, char* argv[]) {
 
+	StatsReport stats;
+
 	EuropeanOption opt;
 
-	if (argc == 2) {
+	BatchFileOptions batch;
+
+	bool binary = false;								//columnar input/output instead of text
+	bool greeks = false;								//add greek columns to columnar results
+	bool convert = false;								//convert between text and columnar files
+	bool serve = false;									//long-running pricing server mode
+	bool perpetual = false;								//perpetual american options instead of european ones
+	PricingServerOptions server;
+	std::size_t cache_entries = 0;						//0 - no result cache
+	int cache_digits = PriceCache::default_digits;
+	std::string rejects_path;							//side file for the lines that weren't priced
+
+	std::vector<std::string> args;						//positional arguments left after taking out the flags
+
+	for (int i = 1; i < argc; i++) {
+
+		std::string arg = argv[i];
+
+		if (arg == "--threads" && i + 1 < argc) {
+			if (!parse_count("--threads", argv[++i], 0, 1024, batch.threads))
+				return 1;
+		}
+		else if (arg == "--binary")
+			binary = true;
+		else if (arg == "--greeks")
+			greeks = true;
+		else if (arg == "--convert")
+			convert = true;
+		else if (arg == "--serve")
+			serve = true;
+		else if (arg == "--perpetual")
+			perpetual = true;
+		else if (arg == "--float")
+			batch.single_precision = true;
+		else if (arg == "--invalid" && i + 1 < argc) {
+			if (!InputValidation::ParsePolicy(argv[++i], batch.policy)) {
+				std::cerr << "--invalid takes clamp, reject or abort." << std::endl;
+				return 1;
+			}
+		}
+		else if (arg == "--rejects" && i + 1 < argc)
+			rejects_path = argv[++i];
+		else if (arg == "--stats")
+			stats.text = true;
+		else if (arg == "--stats-json")
+			stats.json = true;
+		else if (arg == "--socket" && i + 1 < argc)
+			server.socket_path = argv[++i];
+		else if (arg == "--queue" && i + 1 < argc) {
+			if (!parse_count("--queue", argv[++i], 1, 1 << 24, server.queue_capacity))
+				return 1;
+		}
+		else if (arg == "--batch" && i + 1 < argc) {
+			if (!parse_count("--batch", argv[++i], 1, 1 << 20, server.max_batch))
+				return 1;
+		}
+		else if (arg == "--cache" && i + 1 < argc) {
+			if (!parse_count("--cache", argv[++i], 0, 1 << 28, cache_entries))
+				return 1;
+		}
+		else if (arg == "--cache-digits" && i + 1 < argc) {
+			if (!parse_count("--cache-digits", argv[++i], 0, PriceCache::max_digits, cache_digits))
+				return 1;
+		}
+		else
+			args.push_back(arg);
+
+	}
+
+	batch.perpetual = perpetual;
+	server.policy = batch.policy;
+
+	std::unique_ptr<PriceCache> cache;
+	if (cache_entries > 0) {
+		cache.reset(new PriceCache(cache_entries, cache_digits));
+		batch.cache = cache.get();
+		server.cache = cache.get();
+	}
+
+	if (serve && args.empty()) {
+
+		return RunPricingServer(server);
+
+	}
+	else if (args.size() == 1) {
 
-		std::string arg = argv[1];
+		std::string arg = args[0];
 
 		if (arg == "--help" || arg == "-h")
 			std::cout << "\n*** A lightweight, portable and multi-functional plain vanilla option price calculator based "
@@ -30,64 +175,143 @@ int main(int argc, char* argv[]) {
 			<< "Outputs both Call and put prices to console.\n\n"
 			<< "option-calculator inputs.txt outputs.txt\n"
 			<< "Where each line in inputs.txt is 1 2 3 4 5 as described above - calculates respective call + put prices and saves "
-			<< "in outputs.txt\n\n"
+			<< "in outputs.txt\n"
+			<< "Add --threads N to price the file on N threads (0 - all cores), output keeps the input order\n"
+			<< "Add --float to price the file in single precision, about twice as fast, prices within ~1e-4 relative "
+			<< "(see BatchPricing.hpp)\n"
+			<< "Add --invalid clamp|reject|abort to choose what happens to negative or non-finite inputs: replaced by "
+			<< "defaults (the default), left out, or stop at the first one. --rejects file copies the lines that weren't "
+			<< "priced to file\n\n"
+			<< "option-calculator --perpetual 1 2 3 4 5 (or --perpetual inputs.txt outputs.txt)\n"
+			<< "Same for perpetual american options, where 1 - Strike price, 2 - Underlying volatility, "
+			<< "3 - Risk-free interest rate, 4 - Cost of carry (ex. 0.02), 5 - Stock price\n\n"
+			<< "option-calculator inputs.bin outputs.bin [--greeks]\n"
+			<< "Same for binary columnar files (see ColumnarFormat.hpp), selected by the .bin extension or --binary. "
+			<< "--greeks adds delta, gamma, vega, theta and rho columns to the output. --perpetual, --float, --cache, "
+			<< "--invalid and --rejects apply to text files only and are refused here\n\n"
+			<< "option-calculator --convert from to\n"
+			<< "Converts text inputs (.txt) to columnar ones, and columnar inputs or results back to text\n\n"
+			<< "option-calculator --serve [--socket path] [--queue N] [--batch N]\n"
+			<< "Long-running mode: reads 1 2 3 4 5 requests line by line from stdin (or clients of a Unix socket) and answers "
+			<< "each with prices and greeks, 'STATS' prints p50/p99 latency, 'QUIT' disconnects\n\n"
+			<< "Add --cache N to the text file or --serve modes to keep up to N results in an LRU cache, inputs are rounded "
+			<< "to --cache-digits D decimals (0 to 12, default 8) and repeated contracts are answered from it\n\n"
+			<< "Add --stats (or --stats-json) to any mode to print stage times of the file mode (parse, price, format, write), "
+			<< "Simpson refinements and clamped inputs to stderr at exit\n\n"
 			<< "Enjoy :^)\n\n";
 			 
 	}
-	else if (argc == 3) {
+	else if (args.size() == 2 && convert) {
 
-		std::string arg1 = argv[1];
-		std::string arg2 = argv[2];
+		if (perpetual) {								//columnar files hold european contracts only
+			std::cerr << "--perpetual can't be combined with --convert." << std::endl;
+			return 1;
+		}
+
+		if (!ColumnarFormat::Convert(args[0], args[1], std::cerr))
+			return 1;
+
+	}
+	else if (args.size() == 2 && (binary || (is_bin(args[0]) && is_bin(args[1])))) {
+
+		const char* unsupported = perpetual ? "--perpetual" : batch.single_precision ? "--float" :
+			cache ? "--cache" : !rejects_path.empty() ? "--rejects" :
+			batch.policy != InputValidation::Policy::Clamp ? "--invalid" : nullptr;
+		if (unsupported) {								//the columnar path prices european contracts in double precision only
+			std::cerr << unsupported << " is not supported for columnar (.bin) files." << std::endl;
+			return 1;
+		}
+
+		if (!ColumnarFormat::PriceFile(args[0], args[1], greeks, batch.threads, std::cerr))
+			return 1;
+
+	}
+	else if (args.size() == 2) {
+
+		std::string arg1 = args[0];
+		std::string arg2 = args[1];
 
-		if (arg1.substr(arg1.size() - 4) != ".txt" || arg2.substr(arg2.size() - 4) != ".txt") {
+		if (arg1.size() < 4 || arg2.size() < 4 ||
+			arg1.substr(arg1.size() - 4) != ".txt" || arg2.substr(arg2.size() - 4) != ".txt") {
 			std::cerr << "Incorrect command, please check --help." << std::endl;
 			return 1;
 		}
 
-		std::ifstream inputFile(arg1);
-		std::ofstream outputFile(arg2);
+		MappedFile inputFile(arg1);
+		std::ofstream outputFile(arg2, std::ios::binary);
+		std::ofstream rejectsFile;
+
+		if (!rejects_path.empty()) {
+			rejectsFile.open(rejects_path, std::ios::binary);
+			batch.rejects = &rejectsFile;
+		}
 
-		if (!inputFile || !outputFile) {
-			std::cerr << "Error opening files: " << arg1  << " " << arg2 << std::endl;
+		if (!inputFile.is_open() || !outputFile || (batch.rejects && !rejectsFile)) {
+			std::cerr << "Error opening files: " << arg1  << " " << arg2 << " " << rejects_path << std::endl;
 			return 1;
 		}
 
-		std::string line;
+		BatchFileResult res = PriceTextFile(inputFile.data(), inputFile.size(), outputFile, std::cerr, batch);
 
-		int cnt = 1;
+		inputFile.close();
+		outputFile.close();
 
-		while (std::getline(inputFile, line)) {
+		if (cache)
+			std::cerr << cache->StatsText() << std::endl;
 
-			std::istringstream iss(line);
+		std::string summary = InputValidation::Summary(res.validation, batch.policy);
+		if (!summary.empty())
+			std::cerr << summary << "." << std::endl;
 
-			std::vector<std::string> params;
+		if (res.aborted_line) {
+			std::cerr << "line " << res.aborted_line << ": invalid " << InputValidation::Describe(res.aborted_status)
+				<< ", stopped." << std::endl;
+			return 1;
+		}
 
-			std::string word;
+		if (res.errors) {
+			std::cerr << res.errors << " of " << res.lines << " lines in " << arg1 << " couldn't be parsed." << std::endl;
+			return 1;
+		}
 
-			while (iss >> word) params.push_back(word);
+	}
+	else if (args.size() == 5 && perpetual) {
 
-			opt.T(stof(params[0]));
-			opt.K(stof(params[1]));
-			opt.vol(stof(params[2]));
-			opt.r(stof(params[3]));
-			opt.S(stof(params[4]));
+		PerpetualAmericanOption perp;
 
-			outputFile << "Option #" << std::to_string(cnt++) << ": Call = " << std::to_string(opt.Call())
-				<< ", Put = " << std::to_string(opt.Put()) << '\n';
+		double K = atof(args[0].c_str()), vol = atof(args[1].c_str()), r = atof(args[2].c_str()),
+			b = atof(args[3].c_str()), S = atof(args[4].c_str());
+		InputValidation::Status status;
 
-		}
+		InputValidation::Perpetual(&S, &K, &r, &b, &vol, &status, 1, batch.policy);
+		if (!check_quote(status, batch.policy))
+			return 1;
 
-		inputFile.close();
-		outputFile.close();
+		perp.K(K);
+		perp.vol(vol);
+		perp.r(r);
+		perp.b(b);
+		perp.S(S);
+
+		std::cout << "Perpetual american option prices: Call = " << perp.Call()
+			<< ", Put = " << perp.Put() << std::endl;
 
 	}
-	else if (argc == 6) {
+	else if (args.size() == 5) {
+
+		double T = atof(args[0].c_str()), K = atof(args[1].c_str()), vol = atof(args[2].c_str()),
+			r = atof(args[3].c_str()), S = atof(args[4].c_str());
+		InputValidation::Status status;
+
+		InputValidation::European(&S, &K, &T, &r, &vol, &status, 1, batch.policy);
+		if (!check_quote(status, batch.policy))
+			return 1;
 
-		opt.T( atof(argv[1]) );
-		opt.K( atof(argv[2]) );
-		opt.vol( atof(argv[3]) );
-		opt.r( atof(argv[4]) );
-		opt.S( atof(argv[5]) );
+		opt.T(T);
+		opt.K(K);
+		opt.vol(vol);
+		opt.r(r);
+		opt.S(S);
 
 		std::cout << "European option prices: Call = " << opt.Call()
 			<< ", Put = " << opt.Put() << std::endl;